@@ -0,0 +1,63 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 14: ADSR
+*/
+
+// EventQueue.h: a queue of parameter changes, each timestamped with the
+// audio frame where it should happen. Space is allocated once in setup(),
+// and one thread can add events while another takes them out without
+// any locks, so it is safe to use from render().
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class EventQueue {
+public:
+	// One parameter change: what to change, its new value and when
+	struct Event {
+		uint64_t frame;			// Audio frame (counting from the start of the program)
+		unsigned int target;	// Which parameter the event is for
+		float value;			// The new value
+	};
+
+	// Constructors: the one with arguments automatically calls setup()
+	EventQueue() {}
+	EventQueue(unsigned int capacity);
+	
+	// Allocate space for at least the given number of events
+	void setup(unsigned int capacity);
+	
+	// Add an event to the end of the queue. Events must be added in
+	// time order. Returns false if the queue is full.
+	bool schedule(uint64_t frame, unsigned int target, float value);
+	
+	// Take the next event out of the queue if it is due at or before
+	// the given frame. Returns false if there is no such event.
+	bool next(uint64_t frame, Event& event);
+	
+	// Return how many frames after currentFrame the next event is due,
+	// up to maxFrames. Late events are due straight away (0).
+	unsigned int framesUntilNext(uint64_t currentFrame, unsigned int maxFrames);
+	
+	// Return whether there are any events waiting
+	bool empty();
+	
+	// Destructor
+	~EventQueue() {}
+
+private:
+	std::vector<Event> events_;					// Circular buffer holding the events
+	unsigned int mask_ = 0;						// Size of the buffer minus 1 (size is a power of 2)
+	std::atomic<unsigned int> readPointer_{0};	// Only changed by the thread taking events out
+	std::atomic<unsigned int> writePointer_{0};	// Only changed by the thread adding events
+};
@@ -18,7 +18,7 @@ adsr-class: Attack-Decay-Sustain-Release envelope implemented as a class
 #include <cmath>
 #include "Wavetable.h"
 #include "Ramp.h"
-#include "Debouncer.h"
+#include "EventQueue.h"
 #include "ADSR.h"
 #include "Filter.h"
 
@@ -29,8 +29,18 @@ const unsigned int kButtonPin = 1;
 Wavetable gOscillator;
 Filter gFilter;
 
-// Button debouncer object
-Debouncer gDebouncer;
+// Button presses and releases, found by scanning the digital input and
+// scheduled at the exact frame they happened
+enum {
+	kEventNoteOn = 0,
+	kEventNoteOff
+};
+EventQueue gEvents;
+
+// Debouncing: after the button changes, ignore it until this frame
+int gButtonState = 1;				// Last debounced button value (1 = not pressed)
+uint64_t gDebounceUntilFrame = 0;
+unsigned int gDebounceInterval = 0;
 
 // ADSR objects
 ADSR gAmplitudeADSR;
@@ -47,6 +57,13 @@ bool setup(BelaContext *context, void *userData)
 {
 	std::vector<float> wavetable;
 	const unsigned int wavetableSize = 512;
+	
+	// Check that audio and digital have the same number of frames
+	// per block, an assumption made in render()
+	if(context->audioFrames != context->digitalFrames) {
+		rt_fprintf(stderr, "This example needs audio and digital running at the same rate.\n");
+		return false;
+	}
 		
 	// Populate a buffer with the first 64 harmonics of a sawtooth wave
 	wavetable.resize(wavetableSize);
@@ -67,8 +84,11 @@ bool setup(BelaContext *context, void *userData)
 	// Initialise the ADSR objects
 	gAmplitudeADSR.setSampleRate(context->audioSampleRate);
 
-	// Initialise the debouncer with 50ms interval
-	gDebouncer.setup(context->audioSampleRate, .05);
+	// Initialise the debouncing with 50ms interval
+	gDebounceInterval = .05 * context->audioSampleRate;
+	
+	// Make space for a few button events per block
+	gEvents.setup(16);
 	
 	// Set up the GUI
 	gGui.setup(context->projectName);
@@ -106,40 +126,61 @@ void render(BelaContext *context, void *userData)
 	gAmplitudeADSR.setReleaseTime(ampReleaseTime);
 	// TODO: set filter ADSR parameters
 
-    for(unsigned int n = 0; n < context->audioFrames; n++) {
-    	// Read the button input: note on is a value of 0
-    	int buttonValue = digitalRead(context, n, kButtonPin);
-    	
-    	// The process() method returns whether the button is high
-    	// or low right now, but we are interested in the edges:
-    	// falling edge is a press, rising edge is a release
-    	gDebouncer.process(buttonValue);
-
-    	if(gDebouncer.fallingEdge()) {
-			// TODO: button pressed: trigger envelope(s)
-    	}    	
-    	if(gDebouncer.risingEdge()) {
-			// TODO: button released: release envelope(s)
-    	}
- 
-		// TODO: get the next value from the ADSR envelope
-    	float amplitude = 0;
-    	
-		// TODO: set the filter frequency based on its ADSR
-    	
-    	// Calculate the output
-    	float out = gOscillator.process() * amplitude;
-		// TODO: apply the filter
-            
-    	for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
-			// Write the sample to every audio output channel
-    		audioWrite(context, n, channel, out);
-    	}
-    	
-    	// Log the audio output and the envelope to the scope
-    	// TODO: also log the filter ADSR
-    	gScope.log(out, amplitude);
-    }
+	uint64_t blockStart = context->audioFramesElapsed;
+	
+	// Look for the button changing. After each change, the input is ignored
+	// until the debounce interval has passed, so bounces are skipped without
+	// running a state machine on every sample.
+	for(unsigned int n = 0; n < context->digitalFrames; n++) {
+		if(blockStart + n < gDebounceUntilFrame)
+			continue;
+		
+		// Read the button input: note on is a value of 0
+		int buttonValue = digitalRead(context, n, kButtonPin);
+		if(buttonValue != gButtonState) {
+			gButtonState = buttonValue;
+			gDebounceUntilFrame = blockStart + n + gDebounceInterval;
+			gEvents.schedule(blockStart + n, buttonValue ? kEventNoteOff : kEventNoteOn, 0);
+		}
+	}
+	
+	unsigned int n = 0;
+	while(n < context->audioFrames) {
+		// Handle any button events that are due at this frame
+		EventQueue::Event event;
+		while(gEvents.next(blockStart + n, event)) {
+			if(event.target == kEventNoteOn) {
+				// Button pressed: trigger the envelope
+				gAmplitudeADSR.trigger();
+			}
+			else if(event.target == kEventNoteOff) {
+				// Button released: release the envelope
+				gAmplitudeADSR.release();
+			}
+		}
+		
+		// Nothing else happens until the next event
+		unsigned int end = n + gEvents.framesUntilNext(blockStart + n, context->audioFrames - n);
+		for(; n < end; n++) {
+			// Get the next value from the ADSR envelope
+			float amplitude = gAmplitudeADSR.process();
+			
+			// TODO: set the filter frequency based on its ADSR
+			
+			// Calculate the output
+			float out = gOscillator.process() * amplitude;
+			// TODO: apply the filter
+			
+			for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
+				// Write the sample to every audio output channel
+				audioWrite(context, n, channel, out);
+			}
+			
+			// Log the audio output and the envelope to the scope
+			// TODO: also log the filter ADSR
+			gScope.log(out, amplitude);
+		}
+	}
 }
 
 void cleanup(BelaContext *context, void *userData)
@@ -0,0 +1,239 @@
+/***** EnvelopeBank.cpp *****/
+
+// A bank of exponential ADSR envelopes rendered one block at a time
+
+#include <cmath>
+#include "EnvelopeBank.h"
+
+// Overshoot ratios, the same as used by the ADSR class
+const float kAttackOvershoot = 1.01;
+const float kDefaultOvershoot = 1.001;
+
+// Constructor taking the sample rate and number of envelopes
+EnvelopeBank::EnvelopeBank(float sampleRate, unsigned int numEnvelopes, unsigned int maxEvents)
+{
+	setup(sampleRate, numEnvelopes, maxEvents);
+}
+
+// Allocate the envelopes and the event list
+void EnvelopeBank::setup(float sampleRate, unsigned int numEnvelopes, unsigned int maxEvents)
+{
+	sampleRate_ = sampleRate;
+	
+	// These only depend on the overshoot, so calculate them once
+	attackLogRatio_ = log(1.0 - 1.0 / kAttackOvershoot);
+	defaultLogRatio_ = log(1.0 - 1.0 / kDefaultOvershoot);
+	
+	// All envelopes start off, holding at 0
+	state_.assign(numEnvelopes, StateOff);
+	asymptoticValue_.assign(numEnvelopes, 0);
+	expValue_.assign(numEnvelopes, 0);
+	multiplier_.assign(numEnvelopes, 1);
+	targetValue_.assign(numEnvelopes, 0);
+	counter_.assign(numEnvelopes, 0);
+	
+	// Same defaults as the ADSR class
+	attackTime_.assign(numEnvelopes, 0.001);
+	decayTime_.assign(numEnvelopes, 0.001);
+	sustainLevel_.assign(numEnvelopes, 1);
+	releaseTime_.assign(numEnvelopes, 0.001);
+	
+	events_.resize(maxEvents);
+	numEvents_ = 0;
+}
+
+// Schedule the start of an envelope
+bool EnvelopeBank::trigger(unsigned int envelope, unsigned int frame)
+{
+	return addEvent(envelope, frame, EventTrigger);
+}
+
+// Schedule the release of an envelope
+bool EnvelopeBank::release(unsigned int envelope, unsigned int frame)
+{
+	return addEvent(envelope, frame, EventRelease);
+}
+
+// Add an event to the list, after any others at the same frame
+bool EnvelopeBank::addEvent(unsigned int envelope, unsigned int frame, EventType type)
+{
+	if(envelope >= state_.size() || numEvents_ >= events_.size())
+		return false;
+	
+	// Shift later events along to make space. The list is short and
+	// mostly arrives in order, so this rarely moves anything.
+	unsigned int i = numEvents_;
+	while(i > 0 && events_[i - 1].frame > frame) {
+		events_[i] = events_[i - 1];
+		i--;
+	}
+	events_[i].frame = frame;
+	events_[i].envelope = envelope;
+	events_[i].type = type;
+	numEvents_++;
+	
+	return true;
+}
+
+// Start a new exponential segment towards the target, from the current value
+void EnvelopeBank::startSegment(unsigned int envelope, float target, float time,
+								float overshootRatio, double logRatio)
+{
+	float currentValue = asymptoticValue_[envelope] + expValue_[envelope];
+	
+	targetValue_[envelope] = target;
+	asymptoticValue_[envelope] = currentValue + (target - currentValue) * overshootRatio;
+	expValue_[envelope] = currentValue - asymptoticValue_[envelope];
+	
+	counter_[envelope] = (int)(sampleRate_ * time);
+	if(counter_[envelope] <= 0) {
+		// No time to ramp: jump straight to the target and hold
+		counter_[envelope] = 0;
+		expValue_[envelope] = target - asymptoticValue_[envelope];
+		multiplier_[envelope] = 1;
+	}
+	else {
+		// The distance to the asymptote shrinks by (1 - 1/overshoot)
+		// over the length of the segment
+		multiplier_[envelope] = expf(logRatio / (time * sampleRate_));
+	}
+}
+
+// Move envelopes whose segment has finished on to the next state
+void EnvelopeBank::updateStates()
+{
+	for(unsigned int e = 0; e < state_.size(); e++) {
+		if(counter_[e] != 0)
+			continue;
+		
+		// A zero-length segment finishes straight away, so keep going
+		// until the envelope reaches a state that holds
+		bool changed = true;
+		while(changed && counter_[e] == 0) {
+			changed = false;
+			if(state_[e] == StateAttack) {
+				state_[e] = StateDecay;
+				startSegment(e, sustainLevel_[e], decayTime_[e], kDefaultOvershoot, defaultLogRatio_);
+				changed = true;
+			}
+			else if(state_[e] == StateDecay) {
+				// No further ramp: hold at the sustain level
+				state_[e] = StateSustain;
+				multiplier_[e] = 1;
+			}
+			else if(state_[e] == StateRelease) {
+				state_[e] = StateOff;
+				multiplier_[e] = 1;
+			}
+		}
+	}
+}
+
+// Calculate the next block of every envelope
+void EnvelopeBank::process(float *output, unsigned int frames)
+{
+	unsigned int numEnvelopes = state_.size();
+	unsigned int currentEvent = 0;
+	unsigned int frame = 0;
+	
+	while(frame < frames) {
+		// Handle any events that happen at this frame
+		while(currentEvent < numEvents_ && events_[currentEvent].frame <= frame) {
+			Event& event = events_[currentEvent++];
+			unsigned int e = event.envelope;
+			if(event.type == EventTrigger) {
+				state_[e] = StateAttack;
+				startSegment(e, 1.0, attackTime_[e], kAttackOvershoot, attackLogRatio_);
+			}
+			else if(state_[e] != StateOff) {
+				state_[e] = StateRelease;
+				startSegment(e, 0.0, releaseTime_[e], kDefaultOvershoot, defaultLogRatio_);
+			}
+		}
+		updateStates();
+		
+		// Find how many frames we can run before the next event or
+		// before any segment finishes. Nothing changes state in between.
+		unsigned int end = frames;
+		if(currentEvent < numEvents_ && events_[currentEvent].frame < end)
+			end = events_[currentEvent].frame;
+		for(unsigned int e = 0; e < numEnvelopes; e++) {
+			if(counter_[e] > 0 && frame + counter_[e] < end)
+				end = frame + counter_[e];
+		}
+		unsigned int run = end - frame;
+		
+		// Update every envelope for each frame. Envelopes that are
+		// holding have a multiplier of 1, so there are no branches here.
+		float *asymptoticValue = asymptoticValue_.data();
+		float *expValue = expValue_.data();
+		float *multiplier = multiplier_.data();
+		for(unsigned int n = frame; n < end; n++) {
+			float *out = &output[n * numEnvelopes];
+			for(unsigned int e = 0; e < numEnvelopes; e++) {
+				out[e] = asymptoticValue[e] + expValue[e];
+				expValue[e] *= multiplier[e];
+			}
+		}
+		
+		// Count down the segments, landing exactly on the target of
+		// any that have finished
+		for(unsigned int e = 0; e < numEnvelopes; e++) {
+			if(counter_[e] > 0) {
+				counter_[e] -= run;
+				if(counter_[e] == 0)
+					expValue_[e] = targetValue_[e] - asymptoticValue_[e];
+			}
+		}
+		
+		frame = end;
+	}
+	
+	// Keep events scheduled beyond this block for the next one
+	unsigned int remaining = 0;
+	for(unsigned int i = currentEvent; i < numEvents_; i++) {
+		events_[remaining] = events_[i];
+		events_[remaining].frame -= frames;
+		remaining++;
+	}
+	numEvents_ = remaining;
+}
+
+// Return the current output of one envelope
+float EnvelopeBank::getValue(unsigned int envelope)
+{
+	return asymptoticValue_[envelope] + expValue_[envelope];
+}
+
+// Indicate whether an envelope is active
+bool EnvelopeBank::isActive(unsigned int envelope)
+{
+	return (state_[envelope] != StateOff);
+}
+
+// Methods to set the value of the parameters, constrained to a
+// sensible range in the same way as the ADSR class
+void EnvelopeBank::setAttackTime(unsigned int envelope, float attackTime)
+{
+	attackTime_[envelope] = (attackTime >= 0) ? attackTime : 0;
+}
+
+void EnvelopeBank::setDecayTime(unsigned int envelope, float decayTime)
+{
+	decayTime_[envelope] = (decayTime >= 0) ? decayTime : 0;
+}
+
+void EnvelopeBank::setSustainLevel(unsigned int envelope, float sustainLevel)
+{
+	if(sustainLevel < 0)
+		sustainLevel_[envelope] = 0;
+	else if(sustainLevel > 1)
+		sustainLevel_[envelope] = 1;
+	else
+		sustainLevel_[envelope] = sustainLevel;
+}
+
+void EnvelopeBank::setReleaseTime(unsigned int envelope, float releaseTime)
+{
+	releaseTime_[envelope] = (releaseTime >= 0) ? releaseTime : 0;
+}
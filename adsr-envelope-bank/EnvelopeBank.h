@@ -0,0 +1,110 @@
+/***** EnvelopeBank.h *****/
+
+// A bank of exponential ADSR envelopes rendered together, one block at
+// a time. Instead of each envelope being its own object, the state of
+// every envelope is held in contiguous arrays so that the inner loop
+// updates all of them at once and can be vectorised by the compiler.
+// Triggers and releases are scheduled as events at a frame within the
+// block, so they happen at exactly the right sample.
+
+#pragma once
+
+#include <vector>
+
+class EnvelopeBank {
+private:
+	// Envelope states, the same as in the ADSR class
+	enum State {
+		StateOff = 0,
+		StateAttack,
+		StateDecay,
+		StateSustain,
+		StateRelease
+	};
+	
+	// Types of event that can be scheduled
+	enum EventType {
+		EventTrigger = 0,
+		EventRelease
+	};
+	
+	// A trigger or release of one envelope at a frame in the block
+	struct Event {
+		unsigned int frame;
+		unsigned int envelope;
+		EventType type;
+	};
+
+public:
+	// Constructors: the one with arguments automatically calls setup()
+	EnvelopeBank() {}
+	EnvelopeBank(float sampleRate, unsigned int numEnvelopes, unsigned int maxEvents = 256);
+	
+	// Allocate space for the envelopes and the event list. This is
+	// the only place memory is allocated.
+	void setup(float sampleRate, unsigned int numEnvelopes, unsigned int maxEvents = 256);
+	
+	// Return the number of envelopes in the bank
+	unsigned int size() { return state_.size(); }
+	
+	// Schedule the start of an envelope (going to the Attack state) or
+	// its release at the given frame of the next block. Frames past the
+	// end of the block carry over to the following blocks. Returns false
+	// if the envelope doesn't exist or the event list is full.
+	bool trigger(unsigned int envelope, unsigned int frame = 0);
+	bool release(unsigned int envelope, unsigned int frame = 0);
+	
+	// Calculate the next block of every envelope. The output is
+	// interleaved: output[n * size() + envelope] for frame n, so it
+	// needs space for frames * size() samples.
+	void process(float *output, unsigned int frames);
+	
+	// Return the current output of one envelope
+	float getValue(unsigned int envelope);
+	
+	// Indicate whether an envelope is in anything other than the Off state
+	bool isActive(unsigned int envelope);
+	
+	// Methods for setting the parameters of each envelope. They take
+	// effect at the start of the next segment.
+	void setAttackTime(unsigned int envelope, float attackTime);
+	void setDecayTime(unsigned int envelope, float decayTime);
+	void setSustainLevel(unsigned int envelope, float sustainLevel);
+	void setReleaseTime(unsigned int envelope, float releaseTime);
+	
+	// Destructor
+	~EnvelopeBank() {}
+
+private:
+	// Add an event to the list, keeping it sorted by frame
+	bool addEvent(unsigned int envelope, unsigned int frame, EventType type);
+	
+	// Start a new exponential segment for one envelope from where it is now
+	void startSegment(unsigned int envelope, float target, float time,
+					  float overshootRatio, double logRatio);
+	
+	// Move to the next state any envelopes whose segment has finished
+	void updateStates();
+
+	float sampleRate_ = 1;
+	double attackLogRatio_ = 0;		// log(1 - 1/overshoot) for the attack segment
+	double defaultLogRatio_ = 0;	// log(1 - 1/overshoot) for the other segments
+	
+	// State of each envelope, indexed by envelope number
+	std::vector<State> state_;
+	std::vector<float> asymptoticValue_;
+	std::vector<float> expValue_;
+	std::vector<float> multiplier_;
+	std::vector<float> targetValue_;
+	std::vector<int> counter_;		// Samples left until the segment is finished
+	
+	// Parameters of each envelope
+	std::vector<float> attackTime_;
+	std::vector<float> decayTime_;
+	std::vector<float> sustainLevel_;
+	std::vector<float> releaseTime_;
+	
+	// Preallocated list of upcoming events, sorted by frame
+	std::vector<Event> events_;
+	unsigned int numEvents_ = 0;
+};
@@ -0,0 +1,200 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 14: ADSR
+adsr-envelope-bank: a strummed chord with many ADSR envelopes calculated
+a block at a time
+*/
+
+#include <Bela.h>
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+#include <libraries/Scope/Scope.h>
+#include <cmath>
+#include "Wavetable.h"
+#include "Debouncer.h"
+#include "EnvelopeBank.h"
+#include "Filter.h"
+
+// Pin declarations
+const unsigned int kButtonPin = 1;
+
+// Number of notes in the chord. Each has its own oscillator and amplitude
+// envelope; the notes are strummed one after another when the button goes down.
+const unsigned int kNumVoices = 4;
+const float kVoiceRatios[kNumVoices] = {1.0, 1.25, 1.5, 2.0};	// Major chord
+const float kStrumTime = 0.03;		// Seconds between the notes of the strum
+unsigned int gStrumInterval = 0;
+
+// Oscillator and Filter objects
+Wavetable gOscillators[kNumVoices];
+Filter gFilter;
+
+// Button debouncer object
+Debouncer gDebouncer;
+
+// All the envelopes, calculated a block at a time: one for the amplitude
+// of each voice, then one for the filter cutoff
+EnvelopeBank gEnvelopes;
+const unsigned int kFilterEnvelope = kNumVoices;
+std::vector<float> gEnvelopeBuffer;
+
+// Browser-based GUI to adjust parameters
+Gui gGui;
+GuiController gGuiController;
+
+// Bela Oscilloscope
+Scope gScope;
+
+bool setup(BelaContext *context, void *userData)
+{
+	std::vector<float> wavetable;
+	const unsigned int wavetableSize = 512;
+	
+	// Check that audio and digital have the same number of frames
+	// per block, an assumption made in render()
+	if(context->audioFrames != context->digitalFrames) {
+		rt_fprintf(stderr, "This example needs audio and digital running at the same rate.\n");
+		return false;
+	}
+		
+	// Populate a buffer with the first 64 harmonics of a sawtooth wave
+	wavetable.resize(wavetableSize);
+	for(unsigned int n = 0; n < wavetable.size(); n++) {
+		wavetable[n] = 0;
+		for(unsigned int harmonic = 1; harmonic <= 48; harmonic++) {
+			wavetable[n] += 0.5 * sinf(2.0 * M_PI * (float)harmonic * (float)n / 
+								 (float)wavetable.size()) / (float)harmonic;
+		}
+	}
+	
+	// Initialise the wavetables, passing the sample rate and the buffer
+	for(unsigned int v = 0; v < kNumVoices; v++)
+		gOscillators[v].setup(context->audioSampleRate, wavetable);
+
+	// Initialise the filter
+	gFilter.setSampleRate(context->audioSampleRate);
+
+	// Initialise the envelopes, with space for one block of their output
+	gEnvelopes.setup(context->audioSampleRate, kNumVoices + 1);
+	gEnvelopeBuffer.resize(context->audioFrames * gEnvelopes.size());
+	gStrumInterval = kStrumTime * context->audioSampleRate;
+
+	// Initialise the debouncer with 50ms interval
+	gDebouncer.setup(context->audioSampleRate, .05);
+	
+	// Set up the GUI
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "ADSR Controller");	
+	
+	// Arguments: name, minimum, maximum, increment, default value
+	gGuiController.addSlider("Frequency", 220, 55, 440, 0);
+	gGuiController.addSlider("Amplitude Attack time", 0.01, 0.001, 0.1, 0);
+	gGuiController.addSlider("Amplitude Decay time", 0.05, 0.01, 0.3, 0);
+	gGuiController.addSlider("Amplitude Sustain level", 0.3, 0, 1, 0);
+	gGuiController.addSlider("Amplitude Release time", 0.2, 0.001, 2, 0);
+	gGuiController.addSlider("Filter base frequency", 200, 50, 1000, 0);
+	gGuiController.addSlider("Filter sensitivity", 3000, 0, 10000, 0);
+	gGuiController.addSlider("Filter Q", 4, 0.5, 10, 0);
+	gGuiController.addSlider("Filter Attack time", 0.05, 0.001, 0.1, 0);
+	gGuiController.addSlider("Filter decay time", 0.1, 0.01, 0.3, 0);
+	gGuiController.addSlider("Filter sustain level", 0.6, 0, 1, 0);
+	gGuiController.addSlider("Filter release time", 0.3, 0.001, 2, 0);
+
+	// Initialise the scope to show the output and the first two envelopes
+	gScope.setup(3, context->audioSampleRate);
+	
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	// Retrieve values from the sliders
+	float frequency = gGuiController.getSliderValue(0);
+	float ampAttackTime = gGuiController.getSliderValue(1);
+	float ampDecayTime = gGuiController.getSliderValue(2);
+	float ampSustainLevel = gGuiController.getSliderValue(3);
+	float ampReleaseTime = gGuiController.getSliderValue(4);
+	float filterBase = gGuiController.getSliderValue(5);
+	float filterSensitivity = gGuiController.getSliderValue(6);
+	float filterQ = gGuiController.getSliderValue(7);
+	float filterAttackTime = gGuiController.getSliderValue(8);
+	float filterDecayTime = gGuiController.getSliderValue(9);
+	float filterSustainLevel = gGuiController.getSliderValue(10);
+	float filterReleaseTime = gGuiController.getSliderValue(11);
+	
+	// Set oscillator and envelope parameters
+	for(unsigned int v = 0; v < kNumVoices; v++) {
+		gOscillators[v].setFrequency(frequency * kVoiceRatios[v]);
+		gEnvelopes.setAttackTime(v, ampAttackTime);
+		gEnvelopes.setDecayTime(v, ampDecayTime);
+		gEnvelopes.setSustainLevel(v, ampSustainLevel);
+		gEnvelopes.setReleaseTime(v, ampReleaseTime);
+	}
+	gEnvelopes.setAttackTime(kFilterEnvelope, filterAttackTime);
+	gEnvelopes.setDecayTime(kFilterEnvelope, filterDecayTime);
+	gEnvelopes.setSustainLevel(kFilterEnvelope, filterSustainLevel);
+	gEnvelopes.setReleaseTime(kFilterEnvelope, filterReleaseTime);
+	gFilter.setQ(filterQ);
+
+	// Look for button presses and releases, and schedule the envelopes to
+	// start or stop at the frame they happened. The voices of the strum
+	// start one after another, even if that is in a later block.
+	for(unsigned int n = 0; n < context->digitalFrames; n++) {
+		// Read the button input: note on is a value of 0
+		int buttonValue = digitalRead(context, n, kButtonPin);
+		
+		// The process() method returns whether the button is high
+		// or low right now, but we are interested in the edges:
+		// falling edge is a press, rising edge is a release
+		gDebouncer.process(buttonValue);
+		
+		if(gDebouncer.fallingEdge()) {
+			for(unsigned int v = 0; v < kNumVoices; v++)
+				gEnvelopes.trigger(v, n + v * gStrumInterval);
+			gEnvelopes.trigger(kFilterEnvelope, n);
+		}
+		if(gDebouncer.risingEdge()) {
+			for(unsigned int v = 0; v < kNumVoices; v++)
+				gEnvelopes.release(v, n + v * gStrumInterval);
+			gEnvelopes.release(kFilterEnvelope, n);
+		}
+	}
+	
+	// Calculate every envelope for the whole block at once
+	gEnvelopes.process(gEnvelopeBuffer.data(), context->audioFrames);
+	
+	for(unsigned int n = 0; n < context->audioFrames; n++) {
+		const float *envelopes = &gEnvelopeBuffer[n * gEnvelopes.size()];
+		
+		// Set the filter frequency based on its envelope
+		float filterControl = envelopes[kFilterEnvelope];
+		gFilter.setFrequency(filterBase + filterSensitivity * filterControl);
+		
+		// Mix the voices, each at the level of its own envelope
+		float out = 0;
+		for(unsigned int v = 0; v < kNumVoices; v++)
+			out += gOscillators[v].process() * envelopes[v];
+		out = 0.5 * gFilter.process(out / kNumVoices);
+		
+		for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
+			// Write the sample to every audio output channel
+			audioWrite(context, n, channel, out);
+		}
+		
+		// Log the audio output, the first voice's envelope and the filter
+		// envelope to the scope
+		gScope.log(out, envelopes[0], filterControl);
+	}
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
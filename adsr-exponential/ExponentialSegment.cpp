@@ -5,12 +5,12 @@
 #include <cmath>
 #include "ExponentialSegment.h"
 
+// the shared cache starts out empty
+ExponentialSegment::CacheEntry ExponentialSegment::cache_[kCacheSize];
+unsigned int ExponentialSegment::nextCacheEntry_ = 0;
+
 //Constructor
-ExponentialSegment::ExponentialSegment()
-{
-	sampleRate_ = 1;
-	setValue(0);
-}
+ExponentialSegment::ExponentialSegment() : ExponentialSegment(1) {}
 
 // constructor specifying a sample rate
 ExponentialSegment::ExponentialSegment(float sampleRate)
@@ -32,7 +32,7 @@ void ExponentialSegment::setValue(float value)
 	asymptoticValue_ = targetValue_ = value;
 	expValue_ = 0;
 	multiplier_ = 0;
-	
+	counter_ = 0;
 }
 
 //ramp to a value over a period of time 
@@ -47,11 +47,49 @@ void ExponentialSegment::rampTo(float value, float time, float overshootRatio)
 	
 	expValue_ = currentValue_ - asymptoticValue_;
 	
-	//calculate time constant to reach the target in the specified time 
-	double tau = -1.0 * time / log(1.0 - 1.0/overshootRatio);
+	// the segment lasts a whole number of samples, which is also
+	// how we know when it is finished
+	counter_ = (int)(sampleRate_ * time);
+	if(counter_ <= 0) {
+		// no time to ramp: jump straight to the target
+		counter_ = 0;
+		expValue_ = targetValue_ - asymptoticValue_;
+		return;
+	}
+	
+	//get the multiplier for each frame 
+	multiplier_ = multiplierFor(time, overshootRatio);
+}
+
+// look up the multiplier for the given segment time and overshoot
+double ExponentialSegment::multiplierFor(float time, float overshootRatio)
+{
+	// ADSR segments are retriggered with the same few parameters over
+	// and over, so most of the time the result is already here
+	for(unsigned int i = 0; i < kCacheSize; i++) {
+		if(cache_[i].valid && cache_[i].time == time &&
+		   cache_[i].overshootRatio == overshootRatio &&
+		   cache_[i].sampleRate == sampleRate_)
+			return cache_[i].multiplier;
+	}
 	
-	//calculate the multiplier for each frame 
-	multiplier_ = pow(exp(-1.0 / tau), 1.0 / sampleRate_);
+	// Not found: we want the distance to the asymptote to shrink by a
+	// factor of (1 - 1/overshootRatio) over time * sampleRate samples.
+	// This is the same as pow(exp(-1/tau), 1/sampleRate) with
+	// tau = -time / log(1 - 1/overshootRatio), with one log and one exp.
+	double multiplier = exp(log(1.0 - 1.0/overshootRatio) / (time * sampleRate_));
+	
+	// remember it in place of the oldest entry
+	CacheEntry& entry = cache_[nextCacheEntry_];
+	entry.time = time;
+	entry.overshootRatio = overshootRatio;
+	entry.sampleRate = sampleRate_;
+	entry.multiplier = multiplier;
+	entry.valid = true;
+	if(++nextCacheEntry_ >= kCacheSize)
+		nextCacheEntry_ = 0;
+	
+	return multiplier;
 }
 
 //Generate and return the next ramp output 
@@ -59,21 +97,23 @@ float ExponentialSegment::process()
 {
 	currentValue_ = asymptoticValue_ + expValue_;
 	
-	if(!finished())
-		expValue_ *= multiplier_;
-		
-		return currentValue_;
+	if(counter_ > 0) {
+		if(--counter_ == 0) {
+			// land exactly on the target so that rounding errors don't build up
+			expValue_ = targetValue_ - asymptoticValue_;
+		}
+		else
+			expValue_ *= multiplier_;
+	}
+	
+	return currentValue_;
 }
 
 //return whether the ramp is finished 
 bool ExponentialSegment::finished()
 {
-	//check if we have reached the target. need to check if we're going up or down 
-	if(currentValue_ >= targetValue_ && currentValue_ <= asymptoticValue_)
-		return true;
-	if(currentValue_ <= targetValue_ && currentValue_ >= asymptoticValue_)
-		return true;
-	return false;
+	// the ramp is finished when the counter has counted down to 0
+	return (counter_ == 0);
 }
 
 //destructor 
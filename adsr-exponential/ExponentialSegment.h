@@ -33,6 +33,24 @@ public:
 	~ExponentialSegment();
 	
 private:
+	// look up the per-sample multiplier for a segment, only calculating
+	// it when these parameters have not been seen recently
+	double multiplierFor(float time, float overshootRatio);
+	
+	// number of recently used multipliers to remember. The cache is shared
+	// by every segment, so the attack, decay and release of several
+	// envelopes with the same settings all fit.
+	static const unsigned int kCacheSize = 16;
+	
+	// one remembered multiplier and the parameters it was calculated for
+	struct CacheEntry {
+		float time;
+		float overshootRatio;
+		double sampleRate;
+		double multiplier;
+		bool valid;
+	};
+	
 	// state variables
 	double sampleRate_;
 	double currentValue_;
@@ -40,4 +58,10 @@ private:
 	double asymptoticValue_;
 	double expValue_;
 	double multiplier_;
-};
\ No newline at end of file
+	int counter_;						// samples left until the target is reached
+	
+	// multipliers for recent segments, shared by all the segments (which
+	// must all run in the same thread, normally the audio thread)
+	static CacheEntry cache_[kCacheSize];
+	static unsigned int nextCacheEntry_;	// which entry to replace next
+};
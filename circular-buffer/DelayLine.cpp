@@ -0,0 +1,66 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// DelayLine.cpp: a circular buffer with power-of-2 wrapping and block copies
+
+#include <cstring>
+#include <algorithm>
+#include "DelayLine.h"
+
+// Constructor taking the longest delay needed
+DelayLine::DelayLine(unsigned int maxDelay)
+{
+	setup(maxDelay);
+}
+
+// Make space for delays of up to maxDelay samples
+void DelayLine::setup(unsigned int maxDelay)
+{
+	// Round up to a power of 2, with space for the newest sample too
+	unsigned int size = 1;
+	while(size < maxDelay + 1)
+		size *= 2;
+	buffer_.assign(size, 0);
+	mask_ = size - 1;
+	writePointer_ = 0;
+}
+
+// Set every sample in the buffer to 0
+void DelayLine::clear()
+{
+	std::fill(buffer_.begin(), buffer_.end(), 0);
+}
+
+// Add a block of samples to the buffer
+void DelayLine::write(const float *input, unsigned int frames)
+{
+	// Copy up to the end of the buffer, then the rest to the start
+	unsigned int start = writePointer_ & mask_;
+	unsigned int first = buffer_.size() - start;
+	if(first > frames)
+		first = frames;
+	memcpy(&buffer_[start], input, first * sizeof(float));
+	memcpy(&buffer_[0], input + first, (frames - first) * sizeof(float));
+	writePointer_ += frames;
+}
+
+// Fill a block with the samples starting delay samples ago
+void DelayLine::read(float *output, unsigned int frames, unsigned int delay)
+{
+	// Copy up to the end of the buffer, then the rest from the start
+	unsigned int start = (writePointer_ - delay) & mask_;
+	unsigned int first = buffer_.size() - start;
+	if(first > frames)
+		first = frames;
+	memcpy(output, &buffer_[start], first * sizeof(float));
+	memcpy(output + first, &buffer_[0], (frames - first) * sizeof(float));
+}
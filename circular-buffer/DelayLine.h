@@ -0,0 +1,65 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// DelayLine: a circular buffer for delay effects. The capacity is always
+// a power of 2, so positions wrap with a bitwise AND instead of % or an if.
+// Blocks are read and written with at most two copies: one up to the end
+// of the buffer and one from the start.
+
+#pragma once
+
+#include <vector>
+
+class DelayLine {
+public:
+	// Constructors: the one with arguments automatically calls setup()
+	DelayLine() {}
+	DelayLine(unsigned int maxDelay);
+	
+	// Make space for delays of up to maxDelay samples and clear the buffer
+	void setup(unsigned int maxDelay);
+	
+	// Set every sample in the buffer to 0
+	void clear();
+	
+	// Return the longest delay this buffer can hold
+	unsigned int maxDelay() { return buffer_.size() - 1; }
+	
+	// Add one sample to the buffer
+	void write(float in) {
+		buffer_[writePointer_ & mask_] = in;
+		writePointer_++;
+	}
+	
+	// Return the sample written delay samples ago: read(1) is the last
+	// sample written. Reading before writing gives a delay of delay samples.
+	float read(unsigned int delay) {
+		return buffer_[(writePointer_ - delay) & mask_];
+	}
+	
+	// Add a block of samples to the buffer. Blocks can be up to
+	// maxDelay() + 1 samples long.
+	void write(const float *input, unsigned int frames);
+	
+	// Fill a block with the samples starting delay samples ago. The block
+	// has to come from samples already written, so delay must be at least
+	// frames: call this before writing the block to delay it by delay samples.
+	void read(float *output, unsigned int frames, unsigned int delay);
+	
+	// Destructor
+	~DelayLine() {}
+	
+private:
+	std::vector<float> buffer_;		// Samples, with a power of 2 size
+	unsigned int mask_ = 0;			// Size of buffer_ minus 1
+	unsigned int writePointer_ = 0;	// Counts up forever; wrapped with mask_ when used
+};
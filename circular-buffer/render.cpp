@@ -14,6 +14,7 @@ circular-buffer: template code for implementing delays
 #include <Bela.h>
 #include <vector>
 #include "MonoFilePlayer.h"
+#include "DelayLine.h"
 
 // Name of the sound file (in project folder)
 std::string gFilename = "slow-drum-loop.wav";
@@ -22,9 +23,12 @@ std::string gFilename = "slow-drum-loop.wav";
 MonoFilePlayer gPlayer;
 
 // TODO: declare variables for circular buffer
-std::vector<float> gDelayBuffer;
-unsigned int gWritePointer = 0;
-unsigned int gReadPointer = 0;
+DelayLine gDelayLine;
+unsigned int gDelayInSamples = 0;
+
+// Blocks of samples going in and out of the circular buffer
+std::vector<float> gInputBuffer;
+std::vector<float> gOutputBuffer;
 
 
 bool setup(BelaContext *context, void *userData)
@@ -41,10 +45,14 @@ bool setup(BelaContext *context, void *userData)
     			gPlayer.size() / context->audioSampleRate);
 
 	// allocate the circular buffer to 0.5 seconds 
-	gDelayBuffer.resize(0.5 * context->audioSampleRate);
+	gDelayLine.setup(0.5 * context->audioSampleRate);
 	
 	//calculate the offset between read and write pointers 
-	gReadPointer = (gWritePointer - (int)(0.1*context->audioSampleRate) + gDelayBuffer.size()) % gDelayBuffer.size();
+	gDelayInSamples = 0.1 * context->audioSampleRate;
+	
+	// allocate one block for the input and one for the output
+	gInputBuffer.resize(context->audioFrames);
+	gOutputBuffer.resize(context->audioFrames);
 	 
 	return true;
 }
@@ -53,25 +61,17 @@ void render(BelaContext *context, void *userData)
 {
     for(unsigned int n = 0; n < context->audioFrames; n++) {
     	//input could come from anywhere
-        float in = gPlayer.process();
-    	
-    	//read the output from the write pointer (oldest sample)
-    	float out = gDelayBuffer[gReadPointer];
-    	
-    	//Overwrite the buffer at the write pointer, the increment and wrap pointer 
-    	gDelayBuffer[gWritePointer] = in; 
-    	
-    	//increment and wrap both the pointers
-    	gWritePointer++;
-    	if(gWritePointer >= gDelayBuffer.size())
-    		gWritePointer = 0;
-    	gReadPointer++;
-    	if(gReadPointer >= gDelayBuffer.size())
-    		gReadPointer = 0;
-        
+        gInputBuffer[n] = gPlayer.process();
+    }
+    
+    //read the delayed block before overwriting it with the new one
+    gDelayLine.read(gOutputBuffer.data(), context->audioFrames, gDelayInSamples);
+    gDelayLine.write(gInputBuffer.data(), context->audioFrames);
+    
+    for(unsigned int n = 0; n < context->audioFrames; n++) {
 		// Write the input and output to different channels
-    	audioWrite(context, n, 0, in);
-    	audioWrite(context, n, 1, out);
+    	audioWrite(context, n, 0, gInputBuffer[n]);
+    	audioWrite(context, n, 1, gOutputBuffer[n]);
     }
 }
 
@@ -0,0 +1,154 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// AudioMemoryPool.cpp: locked, pre-faulted memory for long buffers
+
+#include <cstring>
+#include <sys/mman.h>
+#include "AudioMemoryPool.h"
+
+// Buffers start on 64-byte boundaries (16 samples) to suit the cache
+static const size_t kAlignment = 16;
+
+// Set aside the memory, lock it and touch every page
+bool AudioMemoryPool::setup(size_t samples)
+{
+	cleanup();
+	
+	samples = (samples + kAlignment - 1) / kAlignment * kAlignment;
+	if(samples == 0)
+		return false;
+	
+	void *memory = mmap(nullptr, samples * sizeof(float), PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(memory == MAP_FAILED)
+		return false;
+	memory_ = (float *)memory;
+	size_ = samples;
+	
+	// Locking can fail if the memory limit is too low: the pool still
+	// works, it just might be paged out
+	locked_ = (mlock(memory_, size_ * sizeof(float)) == 0);
+	
+	// Write to every page now, so the first use doesn't have to wait for
+	// the operating system to find the memory
+	memset(memory_, 0, size_ * sizeof(float));
+	
+	// Everything starts as one free piece
+	blocks_[0].start = 0;
+	blocks_[0].size = size_;
+	blocks_[0].used = false;
+	numBlocks_ = 1;
+	
+	return true;
+}
+
+// Borrow a buffer of at least the given number of samples
+float *AudioMemoryPool::allocate(size_t samples)
+{
+	samples = (samples + kAlignment - 1) / kAlignment * kAlignment;
+	if(samples == 0)
+		return nullptr;
+	
+	// Buffers whose size is a power of 2 start on a multiple of their size,
+	// so they never straddle a bigger one's place and the pool doesn't get
+	// broken up into unusable gaps. Other buffers are packed together.
+	size_t alignment = kAlignment;
+	if((samples & (samples - 1)) == 0)
+		alignment = samples;
+	
+	for(unsigned int i = 0; i < numBlocks_; i++) {
+		if(blocks_[i].used)
+			continue;
+		size_t start = (blocks_[i].start + alignment - 1) / alignment * alignment;
+		size_t end = blocks_[i].start + blocks_[i].size;
+		if(start + samples > end)
+			continue;
+		
+		// Split off the free space before and after the buffer, if there
+		// is room in the list. Otherwise try the next piece.
+		unsigned int newBlocks = (start > blocks_[i].start) + (start + samples < end);
+		if(numBlocks_ + newBlocks > kMaxBlocks)
+			continue;
+		if(start > blocks_[i].start) {
+			insertBlock(i, blocks_[i].start, start - blocks_[i].start);
+			i++;
+		}
+		if(start + samples < end)
+			insertBlock(i + 1, start + samples, end - start - samples);
+		blocks_[i].start = start;
+		blocks_[i].size = samples;
+		blocks_[i].used = true;
+		return memory_ + start;
+	}
+	return nullptr;
+}
+
+// Add a free piece to the list at the given index
+void AudioMemoryPool::insertBlock(unsigned int index, size_t start, size_t size)
+{
+	memmove(&blocks_[index + 1], &blocks_[index], (numBlocks_ - index) * sizeof(Block));
+	blocks_[index].start = start;
+	blocks_[index].size = size;
+	blocks_[index].used = false;
+	numBlocks_++;
+}
+
+// Give back a buffer, joining it to any free pieces either side
+void AudioMemoryPool::release(float *buffer)
+{
+	if(buffer == nullptr)
+		return;
+	
+	for(unsigned int i = 0; i < numBlocks_; i++) {
+		if(memory_ + blocks_[i].start != buffer || !blocks_[i].used)
+			continue;
+		
+		blocks_[i].used = false;
+		if(i + 1 < numBlocks_ && !blocks_[i + 1].used) {
+			blocks_[i].size += blocks_[i + 1].size;
+			memmove(&blocks_[i + 1], &blocks_[i + 2], (numBlocks_ - i - 2) * sizeof(Block));
+			numBlocks_--;
+		}
+		if(i > 0 && !blocks_[i - 1].used) {
+			blocks_[i - 1].size += blocks_[i].size;
+			memmove(&blocks_[i], &blocks_[i + 1], (numBlocks_ - i - 1) * sizeof(Block));
+			numBlocks_--;
+		}
+		return;
+	}
+}
+
+// Return the size of the largest free piece
+size_t AudioMemoryPool::largestAvailable()
+{
+	size_t largest = 0;
+	for(unsigned int i = 0; i < numBlocks_; i++) {
+		if(!blocks_[i].used && blocks_[i].size > largest)
+			largest = blocks_[i].size;
+	}
+	return largest;
+}
+
+// Give the memory back to the operating system
+void AudioMemoryPool::cleanup()
+{
+	if(memory_ != nullptr) {
+		if(locked_)
+			munlock(memory_, size_ * sizeof(float));
+		munmap(memory_, size_ * sizeof(float));
+	}
+	memory_ = nullptr;
+	size_ = 0;
+	locked_ = false;
+	numBlocks_ = 0;
+}
@@ -0,0 +1,118 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// DelayLine: a circular buffer for delay effects. The capacity is always
+// a power of 2, so positions wrap with a bitwise AND instead of % or an if.
+// Blocks are read and written with at most two copies: one up to the end
+// of the buffer and one from the start.
+//
+// Delays can also be read at fractional positions, interpolating between
+// samples, so that the delay time can change smoothly without clicks.
+//
+// The buffer either belongs to the delay line or is borrowed from an
+// AudioMemoryPool, for long delays that need to be set up again while
+// the program is running.
+
+#pragma once
+
+#include <vector>
+#include "AudioMemoryPool.h"
+
+class DelayLine {
+public:
+	// Ways of reading between two samples
+	enum Interpolation {
+		InterpolationLinear = 0,	// Straight line between 2 samples
+		InterpolationCubic,			// Cubic Lagrange curve through 4 samples
+		InterpolationAllpass		// First-order allpass filter: flat frequency response,
+									// but only for one reader and slowly changing delays
+	};
+
+	// Constructors: the one with arguments automatically calls setup()
+	DelayLine() {}
+	DelayLine(unsigned int maxDelay);
+	
+	// Make space for delays of up to maxDelay samples and clear the buffer
+	void setup(unsigned int maxDelay);
+	
+	// Same, but borrow the buffer from a pool instead of allocating it.
+	// Returns false, leaving the delay line empty, if the pool is full.
+	bool setup(AudioMemoryPool& pool, unsigned int maxDelay);
+	
+	// Free the buffer or give it back to its pool
+	void release();
+	
+	// Exchange buffers and state with another delay line, without copying
+	// any samples
+	void swap(DelayLine& other);
+	
+	// Set every sample in the buffer to 0
+	void clear();
+	
+	// Return the longest delay this buffer can hold
+	unsigned int maxDelay() { return size_ ? size_ - 1 : 0; }
+	
+	// Add one sample to the buffer
+	void write(float in) {
+		buffer_[writePointer_ & mask_] = in;
+		writePointer_++;
+	}
+	
+	// Return the sample written delay samples ago: read(1) is the last
+	// sample written. Reading before writing gives a delay of delay samples.
+	float read(unsigned int delay) {
+		return buffer_[(writePointer_ - delay) & mask_];
+	}
+	
+	// Add a block of samples to the buffer. Blocks can be up to
+	// maxDelay() + 1 samples long.
+	void write(const float *input, unsigned int frames);
+	
+	// Fill a block with the samples starting delay samples ago. The block
+	// has to come from samples already written, so delay must be at least
+	// frames: call this before writing the block to delay it by delay samples.
+	void read(float *output, unsigned int frames, unsigned int delay);
+	
+	// Return the sample delay samples ago, where delay can be fractional.
+	// delay must be at least 2 for cubic and allpass interpolation, 1 otherwise.
+	float readInterpolated(float delay, Interpolation interpolation);
+	
+	// Fill a block with a different fractional delay for each sample, as if
+	// readInterpolated() were called for each sample before writing it.
+	// Like read(), every delay must reach back before this block: delays[n]
+	// must be at least frames (frames + 1 for cubic and allpass interpolation).
+	void readInterpolated(float *output, const float *delays, unsigned int frames,
+						  Interpolation interpolation);
+	
+	// Destructor
+	~DelayLine() { release(); }
+	
+	// The buffer may be borrowed, so delay lines can't be copied
+	DelayLine(const DelayLine&) = delete;
+	DelayLine& operator=(const DelayLine&) = delete;
+	
+private:
+	// Interpolate between the sample at position in the buffer and the
+	// one before it, fraction of the way back
+	float interpolate(unsigned int position, float fraction, Interpolation interpolation);
+	
+	// Round maxDelay + 1 up to a power of 2
+	static unsigned int bufferSize(unsigned int maxDelay);
+	
+	float *buffer_ = nullptr;		// Samples, with a power of 2 size
+	unsigned int size_ = 0;			// Number of samples in buffer_
+	unsigned int mask_ = 0;			// size_ minus 1
+	std::vector<float> storage_;	// Holds the samples when not borrowed
+	AudioMemoryPool *pool_ = nullptr;	// Pool the samples are borrowed from, if any
+	unsigned int writePointer_ = 0;	// Counts up forever; wrapped with mask_ when used
+	float allpassOutput_ = 0;		// Last output of the allpass interpolator
+};
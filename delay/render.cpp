@@ -13,7 +13,12 @@ circular-buffer: template code for implementing delays
 
 #include <Bela.h>
 #include <vector>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
 #include "MonoFilePlayer.h"
+#include "AudioMemoryPool.h"
+#include "DelayLine.h"
 #include <libraries/Gui/Gui.h>
 #include <libraries/GuiController/GuiController.h>
 
@@ -27,10 +32,61 @@ MonoFilePlayer gPlayer;
 Gui gGui;
 GuiController gGuiController;
 
-//variables for circular buffer and read pointer 
-std::vector<float> gDelayBuffer;
-unsigned int gWritePointer = 0;
-unsigned int gReadPointer = 0;
+// Longest delay time in seconds. The memory set aside in setup() is sized
+// from this: each second of delay needs at least 2 * 4 * sample rate bytes, all
+// locked in RAM, so only raise it if you need longer delays.
+float gMaxDelay = 10.0;
+
+// The slider only goes up to a couple of seconds, so that small movements
+// still give useful delay times
+const float kSliderMaxDelay = 2.0;
+
+// Memory for the delay, set aside and locked in setup(). It has to be
+// declared before the delay lines that borrow from it.
+AudioMemoryPool gMemoryPool;
+
+// Circular buffer for the delay, and blocks of samples going in and out of it
+DelayLine gDelayLine;
+std::vector<float> gInputBuffer;
+std::vector<float> gDelayedBuffer;
+
+// How to read between samples: try linear, cubic or allpass
+DelayLine::Interpolation gInterpolation = DelayLine::InterpolationCubic;
+
+// The delay time glides towards the slider setting over about this many
+// seconds, like the tape speed of a tape delay. gDelayTimes holds the
+// delay in samples for each frame of the block.
+const float kDelaySmoothingTime = 0.05;
+float gDelaySmoothingCoefficient = 0;
+float gDelaySmoothed = 0;
+std::vector<float> gDelayTimes;
+
+// When the delay needs a different size of buffer, a new delay line is
+// set up in a lower-priority task, since clearing a long buffer takes too
+// long to do in render(). Once it is ready, render() writes each block into
+// both lines, and swaps the new one in when it holds as much of the past
+// as the old one, so the echoes carry on across the change.
+AuxiliaryTask gResizeTask;
+DelayLine gNextDelayLine;
+unsigned int gNextMaxDelay = 0;
+unsigned int gMirroredFrames = 0;	// Frames written into both lines so far
+
+// Flags passed between render() and the task. Each side stores with
+// release ordering and loads with acquire ordering, so that whoever sees a
+// flag change also sees the changes to gNextDelayLine made before it.
+std::atomic<bool> gResizePending{false};
+std::atomic<bool> gResizeReady{false};
+
+// Set up the next delay line, borrowing its buffer from the pool. The old
+// buffer in gNextDelayLine is given back first.
+void resize_delay_background(void *)
+{
+	if(!gNextDelayLine.setup(gMemoryPool, gNextMaxDelay))
+		rt_printf("Not enough memory for a delay of %d samples\n", gNextMaxDelay);
+	else
+		gResizeReady.store(true, std::memory_order_release);
+	gResizePending.store(false, std::memory_order_release);
+}
 
 
 bool setup(BelaContext *context, void *userData)
@@ -46,16 +102,44 @@ bool setup(BelaContext *context, void *userData)
     			gFilename.c_str(), gPlayer.size(),
     			gPlayer.size() / context->audioSampleRate);
 
-	// allocate the circular buffer to 0.5 seconds 
-	gDelayBuffer.resize(0.5 * context->audioSampleRate);
+	// set aside enough memory for the longest delay line and the next one
+	// being set up while it plays. The buffers are powers of 2, so twice the
+	// longest always leaves a big enough gap for the next one.
+	unsigned int longest = 1;
+	while(longest < gMaxDelay * context->audioSampleRate + context->audioFrames + 3)
+		longest *= 2;
+	if(!gMemoryPool.setup(2 * longest)) {
+		rt_printf("Error setting aside %d samples for the delay\n", 2 * longest);
+		return false;
+	}
+	if(!gMemoryPool.isLocked())
+		rt_printf("Warning: couldn't lock the delay memory\n");
+	
+	// start with the circular buffer long enough for 0.5 seconds
+	if(!gDelayLine.setup(gMemoryPool, 0.5 * context->audioSampleRate)) {
+		rt_printf("Error setting up the delay line\n");
+		return false;
+	}
+	gResizeTask = Bela_createAuxiliaryTask(resize_delay_background, 50, "bela-resize-delay");
+	
+	// allocate one block for the input and one for the delayed signal
+	gInputBuffer.resize(context->audioFrames);
+	gDelayedBuffer.resize(context->audioFrames);
+	gDelayTimes.resize(context->audioFrames);
+	
+	// one-pole smoothing of the delay time
+	gDelaySmoothingCoefficient = 1.0 - expf(-1.0 / (kDelaySmoothingTime * context->audioSampleRate));
 	
 	// set up the Gui
 	gGui.setup(context->projectName);
 	gGuiController.setup(&gGui, "Delay Controller");
 	
 	//args: name, default value, minimum, maximum, increment (no fixed increment)
-	gGuiController.addSlider("Delay", 0.1, 0, 0.49, 0);
+	gGuiController.addSlider("Delay", 0.1, 0, std::min(kSliderMaxDelay, gMaxDelay), 0);
 	gGuiController.addSlider("Feedback", 0.5, 0, 0.95, 0);
+	
+	// start the delay time at the slider's starting value, not gliding
+	gDelaySmoothed = gGuiController.getSliderValue(0) * context->audioSampleRate;
 	 
 	return true;
 }
@@ -66,39 +150,73 @@ void render(BelaContext *context, void *userData)
 	//Read the delay in seconds
 	float delay = gGuiController.getSliderValue(0);
 	
-	// convert delay to samples 
-	int delayInSamples = delay * context->audioSampleRate;
+	// convert delay to samples. The whole block is read before it is
+	// written, so the delay has to be a little over one block long.
+	float delayInSamples = delay * context->audioSampleRate;
+	if(delayInSamples < context->audioFrames + 1)
+		delayInSamples = context->audioFrames + 1;
+	
+	// once a new delay line is ready, it gets a copy of every block. Swap
+	// it in when it has as much of the past as the old one had to give.
+	bool mirroring = gResizeReady.load(std::memory_order_acquire);
+	if(mirroring &&
+	   gMirroredFrames >= std::min(gDelayLine.maxDelay(), gNextDelayLine.maxDelay())) {
+		gDelayLine.swap(gNextDelayLine);
+		gMirroredFrames = 0;
+		mirroring = false;
+		gResizeReady.store(false, std::memory_order_release);
+	}
+	
+	// ask for a bigger buffer if the delay won't fit (leaving room for the
+	// cubic interpolation), or a smaller one if it uses less than a quarter
+	unsigned int neededDelay = delayInSamples + 2;
+	if(!gResizePending.load(std::memory_order_acquire) &&
+	   !gResizeReady.load(std::memory_order_acquire) &&
+	   (neededDelay > gDelayLine.maxDelay() || 4 * neededDelay < gDelayLine.maxDelay())) {
+		gNextMaxDelay = neededDelay;
+		gResizePending.store(true, std::memory_order_release);
+		Bela_scheduleAuxiliaryTask(gResizeTask);
+	}
+	
+	// until then, stay within the buffer we have
+	float longestDelay = gDelayLine.maxDelay() - 2;
+	if(delayInSamples > longestDelay)
+		delayInSamples = longestDelay;
+	if(gDelaySmoothed > longestDelay)
+		gDelaySmoothed = longestDelay;
 	
-	//calculate the read pointer based on the write pointer 
-	gReadPointer = (gWritePointer - delayInSamples + gDelayBuffer.size()) % gDelayBuffer.size();
+	// glide towards the new delay a sample at a time
+	for(unsigned int n = 0; n < context->audioFrames; n++) {
+		gDelaySmoothed += gDelaySmoothingCoefficient * (delayInSamples - gDelaySmoothed);
+		gDelayTimes[n] = gDelaySmoothed;
+	}
 	
 	//get Feedback level 
 	float feedback = gGuiController.getSliderValue(1);
 	
+	//read the whole block of delayed samples at once, between samples where needed
+	gDelayLine.readInterpolated(gDelayedBuffer.data(), gDelayTimes.data(), context->audioFrames,
+								gInterpolation);
+	
     for(unsigned int n = 0; n < context->audioFrames; n++) {
     	float in = gPlayer.process();
+    	float out = gDelayedBuffer[n];
     	
-    	//read the output from the write pointer (oldest sample) 
-    	float out = gDelayBuffer[gReadPointer];
-    	
-    	//Overwrite the buffer at the write pointer, the increment and wrap pointer 
-    	// do this first so we can have the read and write pointers be equal
-    	gDelayBuffer[gWritePointer] = in + out * feedback; 
-    	
-    	
-    	
-    	//increment and wrap both the pointers
-    	gWritePointer++;
-    	if(gWritePointer >= gDelayBuffer.size())
-    		gWritePointer = 0;
-    	gReadPointer++;
-    	if(gReadPointer >= gDelayBuffer.size())
-    		gReadPointer = 0;
+    	//the input and feedback go into the delay
+    	gInputBuffer[n] = in + out * feedback;
         
 		// Write the input and output to different channels
     	audioWrite(context, n, 1, in);
     	audioWrite(context, n, 0, out);
     }
+    
+    //write the whole block into the delay at once, and into the next
+    //delay line if it is catching up
+    gDelayLine.write(gInputBuffer.data(), context->audioFrames);
+    if(mirroring) {
+    	gNextDelayLine.write(gInputBuffer.data(), context->audioFrames);
+    	gMirroredFrames += context->audioFrames;
+    }
 }
 
 void cleanup(BelaContext *context, void *userData)
@@ -0,0 +1,124 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// DelayLine.cpp: a circular buffer with power-of-2 wrapping, block copies
+// and interpolated reads
+
+#include <cstring>
+#include <algorithm>
+#include "DelayLine.h"
+
+// Constructor taking the longest delay needed
+DelayLine::DelayLine(unsigned int maxDelay)
+{
+	setup(maxDelay);
+}
+
+// Make space for delays of up to maxDelay samples
+void DelayLine::setup(unsigned int maxDelay)
+{
+	// Round up to a power of 2, with space for the newest sample too
+	unsigned int size = 1;
+	while(size < maxDelay + 1)
+		size *= 2;
+	buffer_.assign(size, 0);
+	mask_ = size - 1;
+	writePointer_ = 0;
+	allpassOutput_ = 0;
+}
+
+// Set every sample in the buffer to 0
+void DelayLine::clear()
+{
+	std::fill(buffer_.begin(), buffer_.end(), 0);
+	allpassOutput_ = 0;
+}
+
+// Add a block of samples to the buffer
+void DelayLine::write(const float *input, unsigned int frames)
+{
+	// Copy up to the end of the buffer, then the rest to the start
+	unsigned int start = writePointer_ & mask_;
+	unsigned int first = buffer_.size() - start;
+	if(first > frames)
+		first = frames;
+	memcpy(&buffer_[start], input, first * sizeof(float));
+	memcpy(&buffer_[0], input + first, (frames - first) * sizeof(float));
+	writePointer_ += frames;
+}
+
+// Fill a block with the samples starting delay samples ago
+void DelayLine::read(float *output, unsigned int frames, unsigned int delay)
+{
+	// Copy up to the end of the buffer, then the rest from the start
+	unsigned int start = (writePointer_ - delay) & mask_;
+	unsigned int first = buffer_.size() - start;
+	if(first > frames)
+		first = frames;
+	memcpy(output, &buffer_[start], first * sizeof(float));
+	memcpy(output + first, &buffer_[0], (frames - first) * sizeof(float));
+}
+
+// Interpolate between the sample at position and the ones around it
+float DelayLine::interpolate(unsigned int position, float fraction, Interpolation interpolation)
+{
+	float x0 = buffer_[position & mask_];
+	float x1 = buffer_[(position - 1) & mask_];
+	
+	if(interpolation == InterpolationLinear)
+		return x0 + fraction * (x1 - x0);
+	
+	if(interpolation == InterpolationCubic) {
+		// Lagrange polynomial through the samples one newer than x0 to two
+		// older, evaluated fraction of the way from x0 to x1
+		float xm1 = buffer_[(position + 1) & mask_];
+		float x2 = buffer_[(position - 2) & mask_];
+		float fp1 = fraction + 1.0, fm1 = fraction - 1.0, fm2 = fraction - 2.0;
+		return -fraction * fm1 * fm2 * (1.0 / 6.0) * xm1
+			   + fp1 * fm1 * fm2 * 0.5 * x0
+			   - fp1 * fraction * fm2 * 0.5 * x1
+			   + fp1 * fraction * fm1 * (1.0 / 6.0) * x2;
+	}
+	
+	// Allpass: y[n] = eta * x0 + x1 - eta * y[n-1], which delays x0 by
+	// about d samples at low frequencies without losing any highs. Its pole
+	// is at -eta, which gets close to z = -1 as d goes to 0 and makes the
+	// filter ring, so d is kept between 0.5 and 1.5 by taking one less whole
+	// sample of delay when the fraction is small.
+	float d = fraction;
+	if(d < 0.5) {
+		d += 1.0;
+		x1 = x0;
+		x0 = buffer_[(position + 1) & mask_];
+	}
+	float eta = (1.0 - d) / (1.0 + d);
+	allpassOutput_ = eta * x0 + x1 - eta * allpassOutput_;
+	return allpassOutput_;
+}
+
+// Return the sample delay samples ago, where delay can be fractional
+float DelayLine::readInterpolated(float delay, Interpolation interpolation)
+{
+	unsigned int delayFrames = delay;
+	return interpolate(writePointer_ - delayFrames, delay - delayFrames, interpolation);
+}
+
+// Fill a block with a different fractional delay for each sample
+void DelayLine::readInterpolated(float *output, const float *delays, unsigned int frames,
+								 Interpolation interpolation)
+{
+	// Sample n of the block would be read after n more samples were written
+	for(unsigned int n = 0; n < frames; n++) {
+		unsigned int delayFrames = delays[n];
+		output[n] = interpolate(writePointer_ + n - delayFrames, delays[n] - delayFrames, interpolation);
+	}
+}
@@ -0,0 +1,209 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// FdnReverb.cpp: a feedback delay network reverb
+
+#include <cmath>
+#include "FdnReverb.h"
+
+// Line lengths in milliseconds for size 1. These are spread out and have
+// no common factors, so their echoes don't line up with each other.
+static const float kLineLengths[] = {
+	29.7, 37.1, 41.1, 43.7, 53.3, 59.1, 67.9, 73.3,
+	31.3, 39.7, 47.9, 51.1, 61.3, 71.9, 79.3, 83.9
+};
+
+// Set up the delay lines
+void FdnReverb::setup(float sampleRate, float size)
+{
+	sampleRate_ = sampleRate;
+	maxRun_ = kMaxRun;
+	
+	for(unsigned int i = 0; i < kNumLines; i++) {
+		lengths_[i] = kLineLengths[i % 16] * 0.001 * size * sampleRate;
+		
+		// Leave room for the modulation
+		delayLines_[i].setup(lengths_[i] + 64);
+		
+		// A run can't be longer than the shortest the line gets when it
+		// is modulated by the most setModulation() allows
+		float shortest = lengths_[i] - 32.0;
+		if(shortest < maxRun_)
+			maxRun_ = (shortest > 1.0) ? shortest : 1;
+		
+		// Spread the lines across the stereo field with alternating signs,
+		// so the two outputs are different from each other
+		outputLeft_[i] = ((i % 2) ? 0.3 : 1.0) * ((i & 2) ? -1.0 : 1.0) / sqrtf(kNumLines);
+		outputRight_[i] = ((i % 2) ? 1.0 : 0.3) * ((i & 4) ? -1.0 : 1.0) / sqrtf(kNumLines);
+		
+		// Start each modulation oscillator at a different point on the circle
+		modulationSin_[i] = sinf(2.0 * M_PI * i / kNumLines);
+		modulationCos_[i] = cosf(2.0 * M_PI * i / kNumLines);
+	}
+	
+	reset();
+	setDecayTime(decayTime_);
+	setDamping(6000.0);
+	setModulation(8.0, 0.5);
+}
+
+// Set the time for the reverb to die away by 60dB
+void FdnReverb::setDecayTime(float seconds)
+{
+	if(seconds < 0.01)
+		seconds = 0.01;
+	decayTime_ = seconds;
+	
+	// Each line loses 60dB over the decay time, however long it is
+	for(unsigned int i = 0; i < kNumLines; i++)
+		decayGains_[i] = powf(10.0, -3.0 * lengths_[i] / (seconds * sampleRate_));
+}
+
+// Set the cutoff of the lowpass filter in each line
+void FdnReverb::setDamping(float cutoff)
+{
+	dampingCoefficient_ = 1.0 - expf(-2.0 * M_PI * cutoff / sampleRate_);
+	if(dampingCoefficient_ > 1.0)
+		dampingCoefficient_ = 1.0;
+}
+
+// Set the depth and rate of the line length modulation
+void FdnReverb::setModulation(float depth, float rate)
+{
+	if(depth < 0)
+		depth = 0;
+	else if(depth > 32.0)
+		depth = 32.0;	// Stay inside the room left in setup()
+	modulationDepth_ = depth;
+	modulationRotateSin_ = sinf(2.0 * M_PI * rate / sampleRate_);
+	modulationRotateCos_ = cosf(2.0 * M_PI * rate / sampleRate_);
+}
+
+// Clear the delay lines
+void FdnReverb::reset()
+{
+	for(unsigned int i = 0; i < kNumLines; i++) {
+		delayLines_[i].clear();
+		filterStates_[i] = 0;
+	}
+}
+
+// Mix a run of each line in place with the chosen matrix, one frame at a
+// time but working along the run. Both matrices keep the total energy the
+// same, so the decay is only set by decayGains_.
+void FdnReverb::mix(float lines[][kMaxRun], unsigned int frames)
+{
+	if(matrix_ == MatrixHadamard) {
+		// Fast Hadamard transform: log2(kNumLines) rounds of sums and differences
+		for(unsigned int step = 1; step < kNumLines; step *= 2) {
+			for(unsigned int i = 0; i < kNumLines; i += 2 * step) {
+				for(unsigned int j = i; j < i + step; j++) {
+					for(unsigned int n = 0; n < frames; n++) {
+						float a = lines[j][n];
+						float b = lines[j + step][n];
+						lines[j][n] = a + b;
+						lines[j + step][n] = a - b;
+					}
+				}
+			}
+		}
+		const float scale = 1.0 / sqrtf(kNumLines);
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			for(unsigned int n = 0; n < frames; n++)
+				lines[i][n] *= scale;
+		}
+	}
+	else {
+		// Householder reflection: subtract 2/N of the sum from every line
+		float sum[kMaxRun];
+		for(unsigned int n = 0; n < frames; n++)
+			sum[n] = 0;
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			for(unsigned int n = 0; n < frames; n++)
+				sum[n] += lines[i][n];
+		}
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			for(unsigned int n = 0; n < frames; n++)
+				lines[i][n] -= sum[n] * (2.0f / kNumLines);
+		}
+	}
+}
+
+// Make a block of stereo reverb from a mono input
+void FdnReverb::process(const float *input, float *left, float *right, unsigned int frames)
+{
+	float lines[kNumLines][kMaxRun];
+	float delays[kMaxRun];
+	
+	unsigned int start = 0;
+	while(start < frames) {
+		unsigned int run = frames - start;
+		if(run > maxRun_)
+			run = maxRun_;
+		
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			// Turn this line's modulation oscillator a sample at a time to
+			// find its modulated length for each frame of the run
+			float s = modulationSin_[i];
+			float c = modulationCos_[i];
+			for(unsigned int n = 0; n < run; n++) {
+				float nextSin = s * modulationRotateCos_ + c * modulationRotateSin_;
+				c = c * modulationRotateCos_ - s * modulationRotateSin_;
+				s = nextSin;
+				delays[n] = lengths_[i] + modulationDepth_ * s;
+			}
+			modulationSin_[i] = s;
+			modulationCos_[i] = c;
+			
+			// Read the run of the line at once
+			delayLines_[i].readInterpolated(lines[i], delays, run, DelayLine::InterpolationLinear);
+			
+			// Damp the high frequencies and apply the decay. The filter
+			// depends on its last output, so it goes one sample at a time.
+			float state = filterStates_[i];
+			float decayGain = decayGains_[i];
+			for(unsigned int n = 0; n < run; n++) {
+				state += dampingCoefficient_ * (lines[i][n] - state);
+				lines[i][n] = state * decayGain;
+			}
+			filterStates_[i] = state;
+		}
+		
+		// Output a different mix of the lines on each side
+		for(unsigned int n = 0; n < run; n++)
+			left[start + n] = right[start + n] = 0;
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			for(unsigned int n = 0; n < run; n++) {
+				left[start + n] += lines[i][n] * outputLeft_[i];
+				right[start + n] += lines[i][n] * outputRight_[i];
+			}
+		}
+		
+		// Mix the lines together and feed them back with the input
+		mix(lines, run);
+		for(unsigned int i = 0; i < kNumLines; i++) {
+			for(unsigned int n = 0; n < run; n++)
+				lines[i][n] += input[start + n];
+			delayLines_[i].write(lines[i], run);
+		}
+		
+		start += run;
+	}
+	
+	// Keep the modulation oscillators from slowly drifting off the circle
+	for(unsigned int i = 0; i < kNumLines; i++) {
+		float correction = 1.5 - 0.5 * (modulationSin_[i] * modulationSin_[i]
+										+ modulationCos_[i] * modulationCos_[i]);
+		modulationSin_[i] *= correction;
+		modulationCos_[i] *= correction;
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// FdnReverb: a feedback delay network reverb. kNumLines delay lines of
+// different lengths feed back into each other through a mixing matrix,
+// so every echo is spread across all the lines and the echoes quickly
+// build up into a dense tail. Each line has a lowpass filter so the high
+// frequencies die away first, like in a real room, and its length is
+// slowly modulated to avoid metallic ringing.
+//
+// The block is worked through in runs shorter than the shortest line, so
+// nothing written during a run is read back within it. Each line reads and
+// writes its whole run at once, and the filtering and mixing are loops
+// along the run that the compiler can vectorise.
+
+#pragma once
+
+#include "DelayLine.h"
+
+class FdnReverb {
+public:
+	// Number of delay lines. This must be a power of 2 for the Hadamard
+	// matrix; 8 is a good balance, 16 is denser but costs twice as much.
+	static const unsigned int kNumLines = 8;
+	
+	// Longest run processed at once, which sets the size of the scratch
+	// buffers
+	static const unsigned int kMaxRun = 64;
+	
+	// How the lines are mixed together when they feed back
+	enum Matrix {
+		MatrixHadamard = 0,		// Every line goes to every other with equal weight
+		MatrixHouseholder		// Each line mostly keeps its own signal, cheaper to compute
+	};
+	
+	// Constructor
+	FdnReverb() {}
+	
+	// Set up the delay lines. size scales the length of all the lines:
+	// 1 is a medium-sized room.
+	void setup(float sampleRate, float size = 1.0);
+	
+	// Set the time in seconds for the reverb to die away by 60dB
+	void setDecayTime(float seconds);
+	
+	// Set the cutoff of the lowpass filter in each line, in Hz
+	void setDamping(float cutoff);
+	
+	// Set how much the line lengths are modulated, in samples, and how fast, in Hz
+	void setModulation(float depth, float rate);
+	
+	// Choose the mixing matrix
+	void setMatrix(Matrix matrix) { matrix_ = matrix; }
+	
+	// Clear the delay lines
+	void reset();
+	
+	// Make a block of stereo reverb (wet signal only) from a mono input
+	void process(const float *input, float *left, float *right, unsigned int frames);
+	
+	// Destructor
+	~FdnReverb() {}
+
+private:
+	// Mix a run of each line in place with the chosen matrix
+	void mix(float lines[][kMaxRun], unsigned int frames);
+	
+	DelayLine delayLines_[kNumLines];
+	float sampleRate_ = 44100.0;
+	Matrix matrix_ = MatrixHadamard;
+	float decayTime_ = 2.0;
+	float dampingCoefficient_ = 1.0;
+	float modulationDepth_ = 0;
+	unsigned int maxRun_ = 1;			// Longest run that fits in the shortest line
+	
+	// Settings and state for each line
+	float lengths_[kNumLines];			// Length of each line in samples, without modulation
+	float decayGains_[kNumLines];		// Gain each time round the line, for the decay time
+	float filterStates_[kNumLines];		// Last output of each lowpass filter
+	float modulationSin_[kNumLines];	// Modulation oscillator for each line, as a
+	float modulationCos_[kNumLines];	// point going round a circle
+	float modulationRotateSin_ = 0;		// How far the oscillators turn each sample
+	float modulationRotateCos_ = 1.0;
+	float outputLeft_[kNumLines];		// Gain from each line to the left output
+	float outputRight_[kNumLines];		// Gain from each line to the right output
+};
@@ -7,7 +7,7 @@
 
 http://bela.io
 
-C++ Real-Time Audio Programming with Bela - Lecture 8: Filters
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
 */
 
 // This is a simple class encapsulating the playback of a sound
@@ -0,0 +1,104 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+fdn-reverb: a reverb made from delay lines that feed back into each other
+*/
+
+#include <Bela.h>
+#include <vector>
+#include "MonoFilePlayer.h"
+#include "FdnReverb.h"
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+
+// Name of the sound file (in project folder)
+std::string gFilename = "slow-drum-loop.wav";
+
+// Object that handles playing sound from a buffer
+MonoFilePlayer gPlayer;
+
+// Bela slider Gui
+Gui gGui;
+GuiController gGuiController;
+
+// The reverb, and blocks of samples going in and out of it
+FdnReverb gReverb;
+std::vector<float> gInputBuffer;
+std::vector<float> gLeftBuffer;
+std::vector<float> gRightBuffer;
+
+// Last slider settings, so the reverb is only updated when they change
+float gDecayTime = 0;
+float gDamping = 0;
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Load the audio file
+	if(!gPlayer.setup(gFilename)) {
+    	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
+    	return false;
+	}
+
+	// Print some useful info
+    rt_printf("Loaded the audio file '%s' with %d frames (%.1f seconds)\n", 
+    			gFilename.c_str(), gPlayer.size(),
+    			gPlayer.size() / context->audioSampleRate);
+    
+	// Set up the reverb for a medium-sized room
+	gReverb.setup(context->audioSampleRate);
+	
+	// Make space for one block of input and output
+	gInputBuffer.resize(context->audioFrames);
+	gLeftBuffer.resize(context->audioFrames);
+	gRightBuffer.resize(context->audioFrames);
+	
+	// set up the Gui
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "Reverb Controller");
+	
+	//args: name, default value, minimum, maximum, increment (no fixed increment)
+	gGuiController.addSlider("Decay time", 2.0, 0.2, 10.0, 0);
+	gGuiController.addSlider("Damping", 6000, 500, 16000, 0);
+	gGuiController.addSlider("Wet level", 0.3, 0, 1, 0);
+	 
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	// Recalculate the reverb settings only when the sliders move
+	float decayTime = gGuiController.getSliderValue(0);
+	if(decayTime != gDecayTime) {
+		gDecayTime = decayTime;
+		gReverb.setDecayTime(decayTime);
+	}
+	float damping = gGuiController.getSliderValue(1);
+	if(damping != gDamping) {
+		gDamping = damping;
+		gReverb.setDamping(damping);
+	}
+	float wetLevel = gGuiController.getSliderValue(2);
+	
+    for(unsigned int n = 0; n < context->audioFrames; n++)
+    	gInputBuffer[n] = gPlayer.process();
+    
+    // Make the whole block of reverb at once
+    gReverb.process(gInputBuffer.data(), gLeftBuffer.data(), gRightBuffer.data(), context->audioFrames);
+    
+    for(unsigned int n = 0; n < context->audioFrames; n++) {
+		// Mix the dry sound with the reverb in stereo
+    	audioWrite(context, n, 0, gInputBuffer[n] + wetLevel * gLeftBuffer[n]);
+    	audioWrite(context, n, 1, gInputBuffer[n] + wetLevel * gRightBuffer[n]);
+    }
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
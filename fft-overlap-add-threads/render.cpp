@@ -19,20 +19,24 @@ fft-overlap-add-threads: overlap-add framework doing FFT in a low-priority threa
 #include <vector>
 #include <algorithm>
 #include "MonoFilePlayer.h"
+#include "MirroredBuffer.h"
 
 // FFT-related variables
 Fft gFft;					// FFT processing object
 const int gFftSize = 1024;	// FFT window size in samples
 const int gHopSize = 256;	// How often we calculate a window
 
-// Circular buffer and pointer for assembling a window of samples
+// Circular buffer and pointer for assembling a window of samples. The
+// buffers are mirrored, so a whole window can be read from anywhere in
+// them without wrapping around. MirroredBuffer rounds the size up to whole
+// memory pages, so the pointers wrap at size() rather than gBufferSize.
 const int gBufferSize = 16384;
-std::vector<float> gInputBuffer(gBufferSize);
+MirroredBuffer gInputBuffer;
 int gInputBufferPointer = 0;
 int gHopCounter = 0;
 
 // Circular buffer for collecting the output of the overlap-add process
-std::vector<float> gOutputBuffer(gBufferSize);
+MirroredBuffer gOutputBuffer;
 int gOutputBufferWritePointer = 2*gHopSize;	// Need one extra hop of latency to run in second thread
 int gOutputBufferReadPointer = 0;
 
@@ -64,6 +68,12 @@ bool setup(BelaContext *context, void *userData)
     			gFilename.c_str(), gPlayer.size(),
     			gPlayer.size() / context->audioSampleRate);
 	
+	// Set up the circular buffers
+	if(!gInputBuffer.setup(gBufferSize) || !gOutputBuffer.setup(gBufferSize)) {
+		rt_printf("Error allocating the circular buffers\n");
+		return false;
+	}
+	
 	// Set up the FFT and its buffers
 	gFft.setup(gFftSize);
 
@@ -79,16 +89,14 @@ bool setup(BelaContext *context, void *userData)
 // This function handles the FFT processing in this example once the buffer has
 // been assembled.
 
-void process_fft(std::vector<float> const& inBuffer, unsigned int inPointer, std::vector<float>& outBuffer, unsigned int outPointer)
+void process_fft(MirroredBuffer& inBuffer, unsigned int inPointer, MirroredBuffer& outBuffer, unsigned int outPointer)
 {
 	static std::vector<float> unwrappedBuffer(gFftSize);	// Container to hold the unwrapped values
 	
-	// Copy buffer into FFT input, starting one window ago
-	for(int n = 0; n < gFftSize; n++) {
-		// Use modulo arithmetic to calculate the circular buffer index
-		int circularBufferIndex = (inPointer + n - gFftSize + gBufferSize) % gBufferSize;
-		unwrappedBuffer[n] = inBuffer[circularBufferIndex];
-	}
+	// Copy buffer into FFT input, starting one window ago. The window is
+	// always in one piece in the mirrored buffer, so there's no wrapping to do.
+	const float *window = inBuffer.window(inPointer + inBuffer.size() - gFftSize);
+	std::copy(window, window + gFftSize, unwrappedBuffer.begin());
 	
 	// Process the FFT based on the time domain input
 	gFft.fft(unwrappedBuffer);
@@ -104,10 +112,9 @@ void process_fft(std::vector<float> const& inBuffer, unsigned int inPointer, std
 	gFft.ifft();
 	
 	// Add timeDomainOut into the output buffer starting at the write pointer
-	for(int n = 0; n < gFftSize; n++) {
-		int circularBufferIndex = (outPointer + n) % gBufferSize;
-		outBuffer[circularBufferIndex] += gFft.td(n);
-	}
+	float *output = outBuffer.window(outPointer);
+	for(int n = 0; n < gFftSize; n++)
+		output[n] += gFft.td(n);
 }
 
 // This function runs in an auxiliary task on Bela, calling process_fft
@@ -117,7 +124,7 @@ void process_fft_background(void *)
 	process_fft(gInputBuffer, gCachedInputBufferPointer, gOutputBuffer, gOutputBufferWritePointer);
 	
 	// TODO: update the output buffer write pointer to start at the next hop
-	gOutputBufferWritePointer = (gOutputBufferWritePointer + gHopSize) % gBufferSize;
+	gOutputBufferWritePointer = (gOutputBufferWritePointer + gHopSize) % gOutputBuffer.size();
 
 	
 }
@@ -132,7 +139,7 @@ void render(BelaContext *context, void *userData)
 		// Increment the pointer and when full window has been 
 		// assembled, call process_fft()
 		gInputBuffer[gInputBufferPointer++] = in;
-		if(gInputBufferPointer >= gBufferSize) {
+		if(gInputBufferPointer >= (int)gInputBuffer.size()) {
 			// Wrap the circular buffer
 			// Notice: this is not the condition for starting a new FFT
 			gInputBufferPointer = 0;
@@ -149,7 +156,7 @@ void render(BelaContext *context, void *userData)
 		
 		// Increment the read pointer in the output cicular buffer
 		gOutputBufferReadPointer++;
-		if(gOutputBufferReadPointer >= gBufferSize)
+		if(gOutputBufferReadPointer >= (int)gOutputBuffer.size())
 			gOutputBufferReadPointer = 0;
 		
 		// Increment the hop counter and start a new FFT if we've reached the hop size
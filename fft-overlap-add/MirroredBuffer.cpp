@@ -0,0 +1,75 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 18: Phase vocoder, part 1
+*/
+
+// MirroredBuffer.cpp: a circular buffer mapped twice in a row in memory
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include "MirroredBuffer.h"
+
+// Make a buffer of at least minSize samples
+bool MirroredBuffer::setup(unsigned int minSize)
+{
+	release();
+	
+	// The size has to be a whole number of pages for the mapping to work,
+	// and a power of 2 so we can wrap indexes with a mask
+	unsigned int pageSize = sysconf(_SC_PAGESIZE);
+	unsigned int size = pageSize / sizeof(float);
+	while(size < minSize)
+		size *= 2;
+	size_t bytes = size * sizeof(float);
+	
+	// Make some memory that isn't attached to any file. memfd_create() is
+	// called through syscall() because older C libraries don't provide it.
+	int fd = syscall(SYS_memfd_create, "mirrored-buffer", 0);
+	if(fd < 0)
+		return false;
+	if(ftruncate(fd, bytes) != 0) {
+		close(fd);
+		return false;
+	}
+	
+	// Reserve space for two copies, then map the memory into both halves
+	char *base = (char *)mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	bool ok = (base != MAP_FAILED);
+	if(ok) {
+		ok = mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+			 && mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+		if(!ok)
+			munmap(base, 2 * bytes);
+	}
+	
+	// The mappings keep the memory alive without the file descriptor
+	close(fd);
+	if(!ok)
+		return false;
+	
+	data_ = (float *)base;
+	size_ = size;
+	mask_ = size - 1;
+	
+	// Touch every page now so that render() never waits for memory
+	memset(data_, 0, bytes);
+	return true;
+}
+
+// Unmap the memory
+void MirroredBuffer::release()
+{
+	if(data_)
+		munmap(data_, 2 * size_ * sizeof(float));
+	data_ = nullptr;
+	size_ = mask_ = 0;
+}
@@ -0,0 +1,57 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 18: Phase vocoder, part 1
+*/
+
+// MirroredBuffer: a circular buffer whose memory appears twice in a row,
+// so that element size() is the same as element 0, and so on. Any run of
+// up to size() samples starting anywhere in the buffer can then be read or
+// written through one ordinary pointer, without ever wrapping around.
+//
+// This works by asking Linux to map the same memory into two neighbouring
+// places, so it takes no more real memory than a normal buffer.
+
+#pragma once
+
+class MirroredBuffer {
+public:
+	// Constructor
+	MirroredBuffer() {}
+	
+	// Make a buffer of at least minSize samples, filled with zeros. The size
+	// is rounded up to a power of 2 that is a whole number of memory pages.
+	// Returns true on success.
+	bool setup(unsigned int minSize);
+	
+	// Return the number of samples in the buffer
+	unsigned int size() { return size_; }
+	
+	// Return a sample, wrapping the index around the buffer
+	float& operator[](unsigned int index) { return data_[index & mask_]; }
+	
+	// Return a pointer to the sample at index (wrapped around the buffer).
+	// The next size() samples after it can be used without wrapping.
+	float *window(unsigned int index) { return data_ + (index & mask_); }
+	
+	// Destructor: releases the memory
+	~MirroredBuffer() { release(); }
+	
+private:
+	// Unmap the memory, if there is any
+	void release();
+	
+	// The memory can't be shared between two objects
+	MirroredBuffer(const MirroredBuffer&) = delete;
+	MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+	
+	float *data_ = nullptr;		// Start of the first copy; the second follows straight after
+	unsigned int size_ = 0;		// Number of samples in one copy
+	unsigned int mask_ = 0;		// size_ minus 1
+};
@@ -19,20 +19,24 @@ fft-overlap-add: template for implementing phase vocoder effects with overlap-ad
 #include <vector>
 #include <algorithm>
 #include "MonoFilePlayer.h"
+#include "MirroredBuffer.h"
 
 // FFT-related variables
 Fft gFft;					// FFT processing object
 const int gFftSize = 1024;	// FFT window size in samples
 const int gHopSize = 256;	// How often we calculate a window
 
-// Circular buffer and pointer for assembling a window of samples
+// Circular buffer and pointer for assembling a window of samples. The
+// buffers are mirrored, so a whole window can be read from anywhere in
+// them without wrapping around. MirroredBuffer rounds the size up to whole
+// memory pages, so the pointers wrap at size() rather than gBufferSize.
 const int gBufferSize = 16384;
-std::vector<float> gInputBuffer(gBufferSize);
+MirroredBuffer gInputBuffer;
 int gInputBufferPointer = 0;
 int gHopCounter = 0;
 
 // Circular buffer for collecting the output of the overlap-add process
-std::vector<float> gOutputBuffer(gBufferSize);
+MirroredBuffer gOutputBuffer;
 int gOutputBufferWritePointer = gHopSize;		// At minimum, write pointer stays one hop ahead of read pointer
 int gOutputBufferReadPointer = 0;
 
@@ -58,6 +62,12 @@ bool setup(BelaContext *context, void *userData)
     			gFilename.c_str(), gPlayer.size(),
     			gPlayer.size() / context->audioSampleRate);
 	
+	// Set up the circular buffers
+	if(!gInputBuffer.setup(gBufferSize) || !gOutputBuffer.setup(gBufferSize)) {
+		rt_printf("Error allocating the circular buffers\n");
+		return false;
+	}
+	
 	// Set up the FFT
 	gFft.setup(gFftSize);
 	
@@ -70,16 +80,14 @@ bool setup(BelaContext *context, void *userData)
 // This function handles the FFT processing in this example once the buffer has
 // been assembled.
 
-void process_fft(std::vector<float> const& inBuffer, unsigned int inPointer, std::vector<float>& outBuffer, unsigned int outPointer)
+void process_fft(MirroredBuffer& inBuffer, unsigned int inPointer, MirroredBuffer& outBuffer, unsigned int outPointer)
 {
 	static std::vector<float> unwrappedBuffer(gFftSize);	// Container to hold the unwrapped values
 	
-	// Copy buffer into FFT input, starting one window ago
-	for(int n = 0; n < gFftSize; n++) {
-		// Use modulo arithmetic to calculate the circular buffer index
-		int circularBufferIndex = (inPointer + n - gFftSize + gBufferSize) % gBufferSize;
-		unwrappedBuffer[n] = inBuffer[circularBufferIndex];
-	}
+	// Copy buffer into FFT input, starting one window ago. The window is
+	// always in one piece in the mirrored buffer, so there's no wrapping to do.
+	const float *window = inBuffer.window(inPointer + inBuffer.size() - gFftSize);
+	std::copy(window, window + gFftSize, unwrappedBuffer.begin());
 	
 	// Process the FFT based on the time domain input
 	gFft.fft(unwrappedBuffer); 
@@ -95,10 +103,9 @@ void process_fft(std::vector<float> const& inBuffer, unsigned int inPointer, std
 	gFft.ifft();
 	
 	// Add timeDomainOut into the output buffer starting at the write pointer
-	for(int n = 0; n < gFftSize; n++) {
-		int circularBufferIndex = (outPointer + n) % gBufferSize;
-		outBuffer[circularBufferIndex] += gFft.td(n);
-	}
+	float *output = outBuffer.window(outPointer);
+	for(int n = 0; n < gFftSize; n++)
+		output[n] += gFft.td(n);
 }
 
 void render(BelaContext *context, void *userData)
@@ -111,7 +118,7 @@ void render(BelaContext *context, void *userData)
 		// Increment the pointer and when full window has been 
 		// assembled, call process_fft()
 		gInputBuffer[gInputBufferPointer++] = in;
-		if(gInputBufferPointer >= gBufferSize) {
+		if(gInputBufferPointer >= (int)gInputBuffer.size()) {
 			// Wrap the circular buffer
 			// Notice: this is not the condition for starting a new FFT
 			gInputBufferPointer = 0;
@@ -128,7 +135,7 @@ void render(BelaContext *context, void *userData)
 		
 		// TODO: increment the read pointer in the output cicular buffer
 		gOutputBufferReadPointer++;
-		if(gOutputBufferReadPointer >= gBufferSize)
+		if(gOutputBufferReadPointer >= (int)gOutputBuffer.size())
 			gOutputBufferReadPointer = 0;
 		// TODO: increment the hop counter and start a new FFT if we've reached the hop size
 		//       to start a new FFT, call process_fft(). The first three arguments are:
@@ -139,7 +146,7 @@ void render(BelaContext *context, void *userData)
 			gHopCounter = 0;
 			process_fft(gInputBuffer, gInputBufferPointer, gOutputBuffer, gOutputBufferWritePointer);
 			
-			gOutputBufferWritePointer = (gOutputBufferWritePointer + gHopSize) % gBufferSize;
+			gOutputBufferWritePointer = (gOutputBufferWritePointer + gHopSize) % gOutputBuffer.size();
 		}
 		
 		// Write the audio input to left channel, output to the right channel, both to the scope
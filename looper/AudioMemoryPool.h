@@ -0,0 +1,86 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// AudioMemoryPool: one big block of memory, set aside when the program
+// starts, that delay lines and loopers can borrow buffers from. The memory
+// is locked so it can never be swapped out, and every page is touched up
+// front, so using it later never causes a page fault. Borrowing and giving
+// back buffers never calls the operating system, so long buffers can be
+// set up again while the program runs without any surprises.
+//
+// The pool keeps a short fixed list of pieces, in order, each either in
+// use or free. Borrowing takes the first free piece that is big enough;
+// giving one back joins it to any free neighbours. A pool twice the size
+// of the largest power-of-2 buffer always has room for a second buffer of
+// up to that size alongside it. The pool does no locking, so only use it
+// from one thread at a time.
+
+#pragma once
+
+#include <cstddef>
+
+class AudioMemoryPool {
+private:
+	// One piece of the pool
+	struct Block {
+		size_t start;		// Offset from the start of the pool, in samples
+		size_t size;		// Length in samples
+		bool used;			// Whether it has been borrowed
+	};
+
+public:
+	// Most pieces the pool can be split into at once
+	static const unsigned int kMaxBlocks = 64;
+	
+	// Constructor
+	AudioMemoryPool() {}
+	
+	// Set aside space for the given number of samples, locked and
+	// pre-faulted. Returns true on success.
+	bool setup(size_t samples);
+	
+	// Borrow a buffer of at least the given number of samples. Returns
+	// nullptr if there isn't a big enough free piece. The buffer isn't cleared.
+	float *allocate(size_t samples);
+	
+	// Give back a buffer returned by allocate()
+	void release(float *buffer);
+	
+	// Return the total size of the pool in samples
+	size_t size() { return size_; }
+	
+	// Return the size of the largest buffer that could be borrowed now
+	size_t largestAvailable();
+	
+	// Indicate whether the memory could be locked
+	bool isLocked() { return locked_; }
+	
+	// Give the memory back to the operating system
+	void cleanup();
+	
+	// Destructor
+	~AudioMemoryPool() { cleanup(); }
+	
+	// The pool owns its memory, so it can't be copied
+	AudioMemoryPool(const AudioMemoryPool&) = delete;
+	AudioMemoryPool& operator=(const AudioMemoryPool&) = delete;
+
+private:
+	// Add a free piece to the list at the given index
+	void insertBlock(unsigned int index, size_t start, size_t size);
+	
+	float *memory_ = nullptr;
+	size_t size_ = 0;
+	bool locked_ = false;
+	Block blocks_[kMaxBlocks];		// Pieces of the pool, in order of start
+	unsigned int numBlocks_ = 0;
+};
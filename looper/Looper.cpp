@@ -0,0 +1,331 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// Looper.cpp: a live looper with overdub layers and background saving
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <sys/stat.h>
+#include <sndfile.h>
+#include "Looper.h"
+
+// Frames mixed at a time when saving a loop
+static const unsigned int kWriteBufferSize = 4096;
+
+// Borrow every layer from the pool and start empty
+bool Looper::setup(AudioMemoryPool& pool, unsigned int maxLength, float sampleRate)
+{
+	cleanup();
+	
+	pool_ = &pool;
+	sampleRate_ = sampleRate;
+	maxLength_ = maxLength;
+	for(unsigned int i = 0; i < kMaxLayers; i++) {
+		layers_[i] = pool.allocate(maxLength);
+		if(layers_[i] == nullptr) {
+			cleanup();
+			return false;
+		}
+		memset(layers_[i], 0, maxLength * sizeof(float));
+		layerStates_[i].store(LayerClean);
+	}
+	
+	writeBuffer_.resize(kWriteBufferSize);
+	return true;
+}
+
+// Save loops into a directory, keeping at most maxFiles of them
+bool Looper::setRecordingDirectory(const std::string& directory, unsigned int maxFiles)
+{
+	// Make the directory and any missing directories above it
+	for(size_t end = 1; !directory.empty(); end++) {
+		end = directory.find('/', end);
+		std::string partial = directory.substr(0, end);
+		if(mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST)
+			return false;
+		if(end == std::string::npos)
+			break;
+	}
+	
+	recordingDirectory_ = directory;
+	maxFiles_ = maxFiles;
+	fileNumber_ = 0;
+	return true;
+}
+
+// The record button: what it does depends on the state
+void Looper::record()
+{
+	if(state_ == StateEmpty) {
+		// Start recording the first layer
+		if(addLayer()) {
+			state_ = StateRecording;
+			length_ = position_ = 0;
+		}
+	}
+	else if(state_ == StateRecording) {
+		// Close the loop here and play it from the start
+		if(length_ == 0) {
+			clear();
+			return;
+		}
+		state_ = StatePlaying;
+		position_ = 0;
+		saveLoop();
+	}
+	else if(state_ == StatePlaying || state_ == StateStopped) {
+		// Start an overdub in a new layer, if there is one ready
+		if(addLayer())
+			state_ = StateOverdubbing;
+	}
+	else if(state_ == StateOverdubbing) {
+		// Keep the overdub and carry on playing
+		state_ = StatePlaying;
+		saveLoop();
+	}
+}
+
+// Remove the last layer
+void Looper::undo()
+{
+	if(state_ == StateRecording) {
+		clear();
+	}
+	else if(state_ == StateOverdubbing) {
+		removeLayer();
+		state_ = StatePlaying;
+	}
+	else if((state_ == StatePlaying || state_ == StateStopped) && numLayers_ > 1) {
+		removeLayer();
+	}
+}
+
+// Throw away the whole loop
+void Looper::clear()
+{
+	while(numLayers_ > 0)
+		removeLayer();
+	state_ = StateEmpty;
+	length_ = position_ = 0;
+}
+
+// Stop playing, finishing any recording first
+void Looper::stop()
+{
+	if(state_ == StateRecording || state_ == StateOverdubbing)
+		record();
+	if(state_ == StatePlaying)
+		state_ = StateStopped;
+	position_ = 0;
+}
+
+// Start playing from the beginning of the loop
+void Looper::play()
+{
+	if(state_ == StateStopped) {
+		state_ = StatePlaying;
+		position_ = 0;
+	}
+}
+
+// Record from a block of input and write a block of the loop
+void Looper::process(const float *input, float *output, unsigned int frames)
+{
+	if(state_ == StateEmpty || state_ == StateStopped) {
+		memset(output, 0, frames * sizeof(float));
+		return;
+	}
+	
+	if(state_ == StateRecording) {
+		// Copy the input onto the end of the first layer. The loop is
+		// silent until it is closed.
+		unsigned int run = maxLength_ - length_;
+		if(run > frames)
+			run = frames;
+		memcpy(layers_[loopLayers_[0]] + length_, input, run * sizeof(float));
+		memset(output, 0, run * sizeof(float));
+		length_ += run;
+		
+		// If the buffer is full, close the loop and play the rest of the block
+		if(length_ == maxLength_) {
+			record();
+			process(input + run, output + run, frames - run);
+		}
+		return;
+	}
+	
+	// Playing or overdubbing: go through the loop in runs that stop at
+	// the end of the loop, so nothing inside needs to check for wrapping
+	unsigned int n = 0;
+	while(n < frames) {
+		unsigned int run = length_ - position_;
+		if(run > frames - n)
+			run = frames - n;
+		
+		// Mix all the layers
+		memcpy(output + n, layers_[loopLayers_[0]] + position_, run * sizeof(float));
+		for(unsigned int l = 1; l < numLayers_; l++) {
+			const float *layer = layers_[loopLayers_[l]] + position_;
+			for(unsigned int i = 0; i < run; i++)
+				output[n + i] += layer[i];
+		}
+		
+		// Add the input to the top layer, after it has been played, so it
+		// is heard next time round
+		if(state_ == StateOverdubbing) {
+			float *layer = layers_[loopLayers_[numLayers_ - 1]] + position_;
+			for(unsigned int i = 0; i < run; i++)
+				layer[i] += input[n + i];
+		}
+		
+		n += run;
+		position_ += run;
+		if(position_ >= length_)
+			position_ = 0;
+	}
+}
+
+// Find a clean layer and put it on top of the loop
+bool Looper::addLayer()
+{
+	if(numLayers_ >= kMaxLayers)
+		return false;
+	for(unsigned int i = 0; i < kMaxLayers; i++) {
+		if(layers_[i] != nullptr && layerStates_[i].load(std::memory_order_acquire) == LayerClean) {
+			layerStates_[i].store(LayerInUse);
+			loopLayers_[numLayers_++] = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Take the top layer off the loop and have it cleared in the background
+void Looper::removeLayer()
+{
+	if(numLayers_ == 0)
+		return;
+	unsigned int layer = loopLayers_[--numLayers_];
+	layerStates_[layer].store(LayerDirty);
+	
+	Job job;
+	job.type = JobClearLayer;
+	job.length = length_;
+	job.numLayers = 1;
+	job.layers[0] = layer;
+	job.fileNumber = 0;
+	pushJob(job);
+}
+
+// Add a job to the queue, which only the audio thread writes to
+bool Looper::pushJob(const Job& job)
+{
+	unsigned int write = queueWrite_.load(std::memory_order_relaxed);
+	unsigned int read = queueRead_.load(std::memory_order_acquire);
+	if(write - read >= kQueueSize)
+		return false;
+	queue_[write % kQueueSize] = job;
+	queueWrite_.store(write + 1, std::memory_order_release);
+	return true;
+}
+
+// Queue the loop to be saved to disk
+void Looper::saveLoop()
+{
+	if(recordingDirectory_.empty() || maxFiles_ == 0)
+		return;
+	
+	// Always leave room in the queue for clearing every layer, so a slow
+	// disk can't stop layers from being reused. If the disk can't keep
+	// up, this loop isn't saved.
+	unsigned int used = queueWrite_.load(std::memory_order_relaxed)
+						- queueRead_.load(std::memory_order_acquire);
+	if(kQueueSize - used <= kMaxLayers)
+		return;
+	
+	Job job;
+	job.type = JobWriteLoop;
+	job.length = length_;
+	job.numLayers = numLayers_;
+	for(unsigned int l = 0; l < numLayers_; l++)
+		job.layers[l] = loopLayers_[l];
+	job.fileNumber = fileNumber_;
+	fileNumber_ = (fileNumber_ + 1) % maxFiles_;
+	pushJob(job);
+}
+
+// Do the waiting jobs, in the order they were queued. A layer is only
+// cleared after any earlier job that saves it, so the two never overlap.
+void Looper::doBackgroundWork()
+{
+	unsigned int read = queueRead_.load(std::memory_order_relaxed);
+	while(read != queueWrite_.load(std::memory_order_acquire)) {
+		const Job& job = queue_[read % kQueueSize];
+		if(job.type == JobClearLayer) {
+			unsigned int layer = job.layers[0];
+			memset(layers_[layer], 0, job.length * sizeof(float));
+			layerStates_[layer].store(LayerClean, std::memory_order_release);
+		}
+		else if(job.type == JobWriteLoop) {
+			writeLoop(job);
+		}
+		read++;
+		queueRead_.store(read, std::memory_order_release);
+	}
+}
+
+// Mix the layers of a job and write them to a WAV file
+void Looper::writeLoop(const Job& job)
+{
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s/loop-%03u.wav", recordingDirectory_.c_str(), job.fileNumber);
+	
+	SF_INFO info;
+	memset(&info, 0, sizeof(info));
+	info.samplerate = sampleRate_;
+	info.channels = 1;
+	info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+	SNDFILE *file = sf_open(filename, SFM_WRITE, &info);
+	if(file == nullptr) {
+		fprintf(stderr, "Couldn't open '%s' to save the loop: %s\n", filename, sf_strerror(nullptr));
+		return;
+	}
+	
+	for(unsigned int start = 0; start < job.length; start += kWriteBufferSize) {
+		unsigned int frames = job.length - start;
+		if(frames > kWriteBufferSize)
+			frames = kWriteBufferSize;
+		memcpy(writeBuffer_.data(), layers_[job.layers[0]] + start, frames * sizeof(float));
+		for(unsigned int l = 1; l < job.numLayers; l++) {
+			const float *layer = layers_[job.layers[l]] + start;
+			for(unsigned int i = 0; i < frames; i++)
+				writeBuffer_[i] += layer[i];
+		}
+		sf_writef_float(file, writeBuffer_.data(), frames);
+	}
+	sf_close(file);
+}
+
+// Give the layers back to the pool
+void Looper::cleanup()
+{
+	for(unsigned int i = 0; i < kMaxLayers; i++) {
+		if(layers_[i] != nullptr && pool_ != nullptr)
+			pool_->release(layers_[i]);
+		layers_[i] = nullptr;
+	}
+	numLayers_ = 0;
+	state_ = StateEmpty;
+	length_ = position_ = 0;
+	queueRead_.store(queueWrite_.load());
+}
@@ -0,0 +1,164 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// Looper: records live input into a loop and plays it back, with overdubs
+// on top. Each overdub goes into its own layer, so the last ones can be
+// undone. The loop length is set to the exact sample at which recording
+// stops.
+//
+// All the layers are borrowed from an AudioMemoryPool when the looper is
+// set up, so nothing is allocated while it runs. The slow jobs, clearing
+// layers that have been undone and saving finished loops to WAV files, are
+// passed through a queue to doBackgroundWork(), which should be called
+// from a lower-priority thread.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "AudioMemoryPool.h"
+
+class Looper {
+public:
+	// Most layers (the first recording plus overdubs) that can be kept
+	static const unsigned int kMaxLayers = 8;
+	
+	// What the looper is doing
+	enum State {
+		StateEmpty = 0,		// Nothing recorded
+		StateRecording,		// Recording the first layer, setting the length
+		StatePlaying,		// Playing the loop
+		StateOverdubbing,	// Playing the loop and recording a new layer on top
+		StateStopped		// Loop recorded but not playing
+	};
+
+private:
+	// Jobs for the background thread
+	enum JobType {
+		JobClearLayer = 0,	// Set a layer back to silence
+		JobWriteLoop		// Mix the layers and save them to a WAV file
+	};
+	struct Job {
+		JobType type;
+		unsigned int length;				// Loop length in samples
+		unsigned int numLayers;				// Layers to clear or mix
+		unsigned int layers[kMaxLayers];	// Which layer buffers
+		unsigned int fileNumber;			// Number in the saved file name
+	};
+	
+	// What each layer buffer is being used for
+	enum LayerState {
+		LayerClean = 0,		// Silent and ready to record into
+		LayerInUse,			// Part of the loop
+		LayerDirty			// Undone, waiting to be cleared
+	};
+	
+	// Length of the job queue
+	static const unsigned int kQueueSize = 32;
+
+public:
+	// Constructor
+	Looper() {}
+	
+	// Borrow space for loops of up to maxLength samples from the pool.
+	// Returns false if the pool doesn't have room for every layer.
+	bool setup(AudioMemoryPool& pool, unsigned int maxLength, float sampleRate);
+	
+	// Save finished loops as loop-<number>.wav in the given directory,
+	// making it if needed. Only maxFiles loops are kept: after that the
+	// numbers start again from 0, overwriting the oldest. Loops aren't saved
+	// until this is called. Returns false if the directory can't be made.
+	// Call before starting the audio.
+	bool setRecordingDirectory(const std::string& directory, unsigned int maxFiles);
+	
+	// The record button: start recording, close the loop and play it,
+	// start an overdub or finish an overdub, depending on the state
+	void record();
+	
+	// Remove the last layer. While overdubbing, this throws away the
+	// overdub in progress.
+	void undo();
+	
+	// Throw away the whole loop
+	void clear();
+	
+	// Stop playing, or start again from the beginning of the loop
+	void stop();
+	void play();
+	
+	// Return the current state, loop length in samples, number of layers
+	// and position in the loop
+	State state() { return state_; }
+	unsigned int length() { return length_; }
+	unsigned int numLayers() { return numLayers_; }
+	unsigned int position() { return position_; }
+	
+	// Record from a block of input and write a block of the loop. Call
+	// record(), undo() etc. between two shorter blocks to act on an exact sample.
+	void process(const float *input, float *output, unsigned int frames);
+	
+	// Indicate whether there are jobs waiting for doBackgroundWork()
+	bool backgroundWorkPending() { return queueRead_.load() != queueWrite_.load(); }
+	
+	// Do the waiting jobs. Call from a lower-priority thread, not render().
+	void doBackgroundWork();
+	
+	// Give the layers back to the pool
+	void cleanup();
+	
+	// Destructor
+	~Looper() { cleanup(); }
+
+private:
+	// Find a clean layer and put it on top of the loop. Returns false if
+	// none is ready.
+	bool addLayer();
+	
+	// Take the top layer off the loop and have it cleared
+	void removeLayer();
+	
+	// Add a job to the queue. Returns false if the queue is full.
+	bool pushJob(const Job& job);
+	
+	// Queue the loop to be saved to disk
+	void saveLoop();
+	
+	// Mix the layers of a job and write them to a WAV file
+	void writeLoop(const Job& job);
+	
+	AudioMemoryPool *pool_ = nullptr;
+	float sampleRate_ = 44100.0;
+	unsigned int maxLength_ = 0;
+	std::string recordingDirectory_;	// Empty when loops aren't saved
+	unsigned int maxFiles_ = 0;
+	unsigned int fileNumber_ = 0;
+	
+	// The layer buffers, and which of them make up the loop, oldest first
+	float *layers_[kMaxLayers] = {};
+	std::atomic<int> layerStates_[kMaxLayers];
+	unsigned int loopLayers_[kMaxLayers];
+	unsigned int numLayers_ = 0;
+	
+	// Playback state
+	State state_ = StateEmpty;
+	unsigned int length_ = 0;
+	unsigned int position_ = 0;
+	
+	// Queue of jobs from the audio thread to the background thread
+	Job queue_[kQueueSize];
+	std::atomic<unsigned int> queueRead_{0};
+	std::atomic<unsigned int> queueWrite_{0};
+	
+	// Space for mixing the layers before writing them, used by the background thread
+	std::vector<float> writeBuffer_;
+};
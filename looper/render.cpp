@@ -0,0 +1,166 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+looper: records the audio input into a loop, with overdubs that can be undone
+*/
+
+#include <Bela.h>
+#include <vector>
+#include "AudioMemoryPool.h"
+#include "Looper.h"
+
+// Pin declarations. The buttons pull the pins low when pressed.
+const unsigned int kLedPin = 0;				// Lit while recording
+const unsigned int kNumButtons = 4;
+const unsigned int kButtonPins[kNumButtons] = {
+	1,		// Record: start, close the loop, start or finish an overdub
+	2,		// Undo the last layer
+	3,		// Stop or play
+	4		// Clear the whole loop
+};
+
+// Longest loop in seconds. Every layer gets this much memory, all set aside
+// and locked in setup(): Looper::kMaxLayers * 4 * sample rate bytes per
+// second, about 1.4 MB at 44.1 kHz. Only raise it if you need longer loops.
+float gMaxLoopLength = 10.0;
+
+// Where finished loops are saved, and how many are kept before the oldest
+// is overwritten. This is outside the project so recordings aren't copied
+// around with it.
+std::string gRecordingDirectory = "/root/recordings/looper";
+const unsigned int kMaxRecordings = 20;
+
+// How loud the live input is in the output
+const float kMonitorLevel = 1.0;
+
+// Memory for every layer of the loop, set aside and locked in setup(). It
+// has to be declared before the looper that borrows from it.
+AudioMemoryPool gMemoryPool;
+Looper gLooper;
+
+// Blocks of samples going in and out of the looper
+std::vector<float> gInputBuffer;
+std::vector<float> gLoopBuffer;
+
+// Lower-priority task that clears undone layers and saves loops to disk
+AuxiliaryTask gBackgroundTask;
+
+// State for each button: its last value, and how many frames to ignore it
+// for after a press while it stops bouncing
+int gButtonLastValue[kNumButtons];
+int gButtonLockout[kNumButtons];
+int gDebounceInterval = 0;
+
+void looper_background(void *)
+{
+	gLooper.doBackgroundWork();
+}
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Check that audio and digital have the same number of frames
+	// per block, an assumption made in render()
+	if(context->audioFrames != context->digitalFrames) {
+		rt_fprintf(stderr, "This example needs audio and digital running at the same rate.\n");
+		return false;
+	}
+	
+	// Set aside memory for every layer, then let the looper borrow it
+	unsigned int maxLength = gMaxLoopLength * context->audioSampleRate;
+	if(!gMemoryPool.setup((size_t)Looper::kMaxLayers * (maxLength + 16))) {
+		rt_printf("Error setting aside memory for the looper\n");
+		return false;
+	}
+	if(!gMemoryPool.isLocked())
+		rt_printf("Warning: couldn't lock the looper memory\n");
+	if(!gLooper.setup(gMemoryPool, maxLength, context->audioSampleRate)) {
+		rt_printf("Error setting up the looper\n");
+		return false;
+	}
+	
+	// Saving loops is optional: the looper works the same without it
+	if(!gLooper.setRecordingDirectory(gRecordingDirectory, kMaxRecordings))
+		rt_printf("Can't save loops in '%s'\n", gRecordingDirectory.c_str());
+	
+	gBackgroundTask = Bela_createAuxiliaryTask(looper_background, 0, "bela-looper-background");
+	
+	// Make space for one block of input and output
+	gInputBuffer.resize(context->audioFrames);
+	gLoopBuffer.resize(context->audioFrames);
+	
+	// Set up the digital pins
+	pinMode(context, 0, kLedPin, OUTPUT);
+	for(unsigned int b = 0; b < kNumButtons; b++) {
+		pinMode(context, 0, kButtonPins[b], INPUT);
+		gButtonLastValue[b] = 1;
+		gButtonLockout[b] = 0;
+	}
+	gDebounceInterval = 0.05 * context->digitalSampleRate;
+	
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	for(unsigned int n = 0; n < context->audioFrames; n++)
+		gInputBuffer[n] = audioRead(context, n, 0);
+	
+	// Run the looper up to each button press, then act on the press, so
+	// the loop starts and ends on the exact frame the button went down
+	unsigned int start = 0;
+	for(unsigned int n = 0; n < context->digitalFrames; n++) {
+		for(unsigned int b = 0; b < kNumButtons; b++) {
+			int value = digitalRead(context, n, kButtonPins[b]);
+			bool pressed = (value == 0 && gButtonLastValue[b] != 0 && gButtonLockout[b] == 0);
+			gButtonLastValue[b] = value;
+			if(gButtonLockout[b] > 0)
+				gButtonLockout[b]--;
+			if(!pressed)
+				continue;
+			gButtonLockout[b] = gDebounceInterval;
+			
+			gLooper.process(&gInputBuffer[start], &gLoopBuffer[start], n - start);
+			start = n;
+			
+			if(b == 0)
+				gLooper.record();
+			else if(b == 1)
+				gLooper.undo();
+			else if(b == 2) {
+				if(gLooper.state() == Looper::StateStopped)
+					gLooper.play();
+				else
+					gLooper.stop();
+			}
+			else
+				gLooper.clear();
+		}
+		
+		bool recording = (gLooper.state() == Looper::StateRecording ||
+						  gLooper.state() == Looper::StateOverdubbing);
+		digitalWriteOnce(context, n, kLedPin, recording);
+	}
+	gLooper.process(&gInputBuffer[start], &gLoopBuffer[start], context->audioFrames - start);
+	
+	for(unsigned int n = 0; n < context->audioFrames; n++) {
+		// Play the loop with the live input on top
+		float out = gLoopBuffer[n] + kMonitorLevel * gInputBuffer[n];
+		audioWrite(context, n, 0, out);
+		audioWrite(context, n, 1, out);
+	}
+	
+	// Clearing layers and saving loops are too slow for the audio thread
+	if(gLooper.backgroundWorkPending())
+		Bela_scheduleAuxiliaryTask(gBackgroundTask);
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
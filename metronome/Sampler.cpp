@@ -0,0 +1,114 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 9: Timing
+*/
+
+// Sampler.cpp: play overlapping copies of a sound from a fixed pool of voices
+
+#include <cstring>
+#include "Sampler.h"
+
+// Constructor taking the path of a file to load
+Sampler::Sampler(const std::string& filename, unsigned int numVoices)
+{
+	setup(filename, numVoices);
+}
+
+// Load an audio file and make space for the voices
+bool Sampler::setup(const std::string& filename, unsigned int numVoices)
+{
+	// Make all the voices now so trigger() never needs to
+	Voice silent = {false, 0, 0, 0};
+	voices_.assign(numVoices > 0 ? numVoices : 1, silent);
+	
+	// Load the file, or share it if it is already loaded
+	sample_ = SamplePool::global().load(filename);
+	
+	// Check for error
+	return sample_ && sample_->size() > 0;
+}
+
+// Start a new copy of the sound
+void Sampler::trigger(float gain, unsigned int offset)
+{
+	if(size() == 0)
+		return;
+	
+	// Use a free voice if there is one; otherwise steal the one that has
+	// played the most, which is the nearest to finishing anyway
+	Voice *voice = &voices_[0];
+	for(unsigned int i = 0; i < voices_.size(); i++) {
+		if(!voices_[i].active) {
+			voice = &voices_[i];
+			break;
+		}
+		if(voices_[i].position > voice->position)
+			voice = &voices_[i];
+	}
+	
+	voice->active = true;
+	voice->delay = offset;
+	voice->position = 0;
+	voice->gain = gain;
+}
+
+// Stop all the voices
+void Sampler::stopAll()
+{
+	for(unsigned int i = 0; i < voices_.size(); i++)
+		voices_[i].active = false;
+}
+
+// Return how many voices are playing
+unsigned int Sampler::activeVoices()
+{
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < voices_.size(); i++) {
+		if(voices_[i].active)
+			count++;
+	}
+	return count;
+}
+
+// Mix the next block of all the voices into the buffer
+void Sampler::process(float *output, unsigned int frames)
+{
+	memset(output, 0, frames * sizeof(float));
+	
+	for(unsigned int i = 0; i < voices_.size(); i++) {
+		Voice& voice = voices_[i];
+		if(!voice.active)
+			continue;
+		
+		// Voices triggered during this block start partway through it
+		if(voice.delay >= frames) {
+			voice.delay -= frames;
+			continue;
+		}
+		unsigned int start = voice.delay;
+		voice.delay = 0;
+		
+		// Add as much of the sound as fits in the block. This loop has
+		// no branches so the compiler can vectorise it.
+		unsigned int count = sample_->size() - voice.position;
+		if(count > frames - start)
+			count = frames - start;
+		const float *in = sample_->data() + voice.position;
+		float *out = &output[start];
+		float gain = voice.gain;
+		for(unsigned int n = 0; n < count; n++)
+			out[n] += gain * in[n];
+		
+		// Free the voice when the sound has finished
+		voice.position += count;
+		if(voice.position >= sample_->size())
+			voice.active = false;
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 9: Timing
+*/
+
+// Sampler: plays overlapping copies of one sound. The sound is loaded once
+// through the SamplePool, so other samplers or players of the same file share
+// it, and a fixed number of voices read from it, each from its own position
+// and at its own volume. Triggering a voice never allocates memory: if all
+// the voices are busy, the one that has been playing longest is reused.
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include "SamplePool.h"
+
+class Sampler {
+private:
+	// One playing copy of the sound
+	struct Voice {
+		bool active;			// Whether this voice is playing
+		unsigned int delay;		// Frames to wait before starting, within the next block
+		unsigned int position;	// Next frame of the sound to play
+		float gain;				// Volume of this voice
+	};
+
+public:
+	// Constructors: the one with arguments automatically calls setup()
+	Sampler() {}
+	Sampler(const std::string& filename, unsigned int numVoices = 8);
+	
+	// Load an audio file and make space for the given number of voices.
+	// Returns true on success.
+	bool setup(const std::string& filename, unsigned int numVoices = 8);
+	
+	// Start a new copy of the sound with the given volume. The sound starts
+	// offset frames into the next block passed to process(), so triggers
+	// found partway through a block start at exactly the right sample.
+	void trigger(float gain = 1.0, unsigned int offset = 0);
+	
+	// Stop all the voices
+	void stopAll();
+	
+	// Return the length of the sound in samples
+	unsigned int size() { return sample_ ? sample_->size() : 0; }
+	
+	// Return how many voices are playing
+	unsigned int activeVoices();
+	
+	// Fill a buffer with the next block of all the voices mixed together
+	void process(float *output, unsigned int frames);
+	
+	// Destructor
+	~Sampler() {}
+
+private:
+	SamplePool::Sample sample_;			// The sound, shared by all the voices
+	std::vector<Voice> voices_;			// All the voices, playing or not
+};
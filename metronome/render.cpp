@@ -12,13 +12,16 @@ metronome: generate clicks at a regular interval to demonstrate counting time wi
 */
 
 #include <Bela.h>
-#include "MonoFilePlayer.h"
+#include <vector>
+#include "Sampler.h"
 
 const std::string gFilename = "click.wav";	// Name of the sound file (in project folder)
 float gAmplitude = 0.3;						// Volume of the output
-MonoFilePlayer gPlayer;						// File playback object
+Sampler gSampler;							// Plays overlapping clicks
+const unsigned int kNumVoices = 8;			// Most clicks that can overlap
+std::vector<float> gSamplerBuffer;			// One block of output from the sampler
 
-// TODO: declare any needed global variables here
+// Counting time between clicks
 
 unsigned int gMetronomeInterval = 0;	// interval between events
 unsigned int gMetronomeCounter = 0; 	//  number of elapsed samples 
@@ -27,16 +30,19 @@ float kInputTempo = 0;
 
 bool setup(BelaContext *context, void *userData)
 {
-	// Load the audio file; don't play in a loop and don't autostart
-	if(!gPlayer.setup(gFilename, false, false)) {
+	// Load the audio file and make the voices that will play it
+	if(!gSampler.setup(gFilename, kNumVoices)) {
     	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
     	return false;
 	}
 
 	// Print some useful info
     rt_printf("Loaded the audio file '%s' with %d frames (%.1f seconds)\n", 
-    			gFilename.c_str(), gPlayer.size(),
-    			gPlayer.size() / context->audioSampleRate);
+    			gFilename.c_str(), gSampler.size(),
+    			gSampler.size() / context->audioSampleRate);
+    			
+    // Make space for one block of output from the sampler
+    gSamplerBuffer.resize(context->audioFrames);
     			
     // initialize the metronome interval according to sample rate 
     gMetronomeInterval = 0.5 * context->audioSampleRate;
@@ -47,23 +53,23 @@ bool setup(BelaContext *context, void *userData)
 void render(BelaContext *context, void *userData)
 {
     for(unsigned int n = 0; n < context->audioFrames; n++) {
-		// TODO: check if enough time has elapsed, then call gPlayer.trigger()
-		// to start the sound playing if so. You'll need a global variable to count
-		// elapsed samples.
-		
 		float input = analogRead(context, n/2, kInputTempo); // n/2 bc analog inputs have half the sample rate of audio inputs(verify in setup)
 		float bpm = map(input, 0, 3.3/4.096, 20, 600);
 		gMetronomeInterval = 60.0 * context->audioSampleRate / bpm;
 		
+		// Check if enough time has elapsed, and start a click if so
 		if(++gMetronomeCounter >= gMetronomeInterval) {
 			gMetronomeCounter = 0;		//reset the counter 
-			gPlayer.trigger();			//start a new tick
+			gSampler.trigger(gAmplitude, n);	//start a new tick at this frame, on top of any still playing
 		}
-		
-    	// -- code below this point doesn't need to change --
-    	// Get the next sample of the file if it's playing (out = 0 otherwise)
-    	float out = gAmplitude * gPlayer.process();
-        	
+    }
+    
+	// Play all the ticks for this block at once (0 where nothing is playing)
+	gSampler.process(gSamplerBuffer.data(), context->audioFrames);
+	
+    for(unsigned int n = 0; n < context->audioFrames; n++) {
+    	float out = gSamplerBuffer[n];
+    	
     	for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
 			// Write the sample to every audio output channel
     		audioWrite(context, n, channel, out);
@@ -0,0 +1,154 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// MultiTapDelay.cpp: many echoes from one delay line
+
+#include <cmath>
+#include "MultiTapDelay.h"
+
+// Make space for the delay line and turn off all the taps
+void MultiTapDelay::setup(float maxDelay, float sampleRate)
+{
+	sampleRate_ = sampleRate;
+	delayLine_.setup(maxDelay * sampleRate);
+	feedback_ = 0;
+	for(unsigned int t = 0; t < kMaxTaps; t++)
+		clearTap(t);
+}
+
+// Set how much of the taps' output goes back into the delay line
+void MultiTapDelay::setFeedback(float feedback)
+{
+	if(feedback < 0)
+		feedback = 0;
+	else if(feedback > 0.99)
+		feedback = 0.99;
+	feedback_ = feedback;
+	updateFeedbackGain();
+}
+
+// The taps together can add up to more than 1, so the loop could grow
+// without limit even with feedback below 1. Dividing by the total of
+// their gains keeps the gain round the loop below feedback_ at every
+// frequency (the lowpass filters only make it smaller).
+void MultiTapDelay::updateFeedbackGain()
+{
+	float totalGain = 0;
+	for(unsigned int t = 0; t < kMaxTaps; t++)
+		totalGain += fabsf(gains_[t]);
+	feedbackGain_ = (totalGain > 0) ? feedback_ / totalGain : 0;
+}
+
+// Runs can be as long as the shortest delay of the taps in use, since
+// they only read samples written before the run started
+void MultiTapDelay::updateShortestDelay()
+{
+	shortestDelay_ = kMaxRun;
+	for(unsigned int t = 0; t < kMaxTaps; t++) {
+		if(gains_[t] != 0 && delays_[t] < shortestDelay_)
+			shortestDelay_ = delays_[t];
+	}
+}
+
+// Set the delay, gain, pan and filter of one tap
+void MultiTapDelay::setTap(unsigned int tap, float delay, float gain, float pan, float cutoff)
+{
+	if(tap >= kMaxTaps)
+		return;
+	
+	// Every tap reads from before the sample about to be written
+	unsigned int delayInSamples = delay * sampleRate_;
+	if(delayInSamples < 1)
+		delayInSamples = 1;
+	if(delayInSamples > delayLine_.maxDelay())
+		delayInSamples = delayLine_.maxDelay();
+	delays_[tap] = delayInSamples;
+	
+	// Equal-power panning
+	if(pan < 0)
+		pan = 0;
+	else if(pan > 1)
+		pan = 1;
+	gains_[tap] = gain;
+	gainsLeft_[tap] = gain * cosf(0.5 * M_PI * pan);
+	gainsRight_[tap] = gain * sinf(0.5 * M_PI * pan);
+	
+	// One-pole lowpass: y[n] = y[n-1] + c * (x[n] - y[n-1])
+	filterCoefficients_[tap] = 1.0 - expf(-2.0 * M_PI * cutoff / sampleRate_);
+	if(filterCoefficients_[tap] > 1.0)
+		filterCoefficients_[tap] = 1.0;
+	
+	updateFeedbackGain();
+	updateShortestDelay();
+}
+
+// Turn off one tap
+void MultiTapDelay::clearTap(unsigned int tap)
+{
+	if(tap >= kMaxTaps)
+		return;
+	delays_[tap] = 1;
+	gains_[tap] = gainsLeft_[tap] = gainsRight_[tap] = 0;
+	filterCoefficients_[tap] = 1.0;
+	filterStates_[tap] = 0;
+	updateFeedbackGain();
+	updateShortestDelay();
+}
+
+// Delay a block of input, writing the taps mixed to stereo
+void MultiTapDelay::process(const float *input, float *left, float *right, unsigned int frames)
+{
+	float tap[kMaxRun];
+	float feedback[kMaxRun];
+	
+	unsigned int n = 0;
+	while(n < frames) {
+		unsigned int run = frames - n;
+		if(run > shortestDelay_)
+			run = shortestDelay_;
+		
+		for(unsigned int i = 0; i < run; i++)
+			left[n + i] = right[n + i] = feedback[i] = 0;
+		
+		for(unsigned int t = 0; t < kMaxTaps; t++) {
+			if(gains_[t] == 0)
+				continue;
+			
+			// Copy this tap's samples for the whole run, then filter them.
+			// The filter depends on its last output, so it goes one sample
+			// at a time.
+			delayLine_.read(tap, run, delays_[t]);
+			float state = filterStates_[t];
+			float coefficient = filterCoefficients_[t];
+			for(unsigned int i = 0; i < run; i++) {
+				state += coefficient * (tap[i] - state);
+				tap[i] = state;
+			}
+			filterStates_[t] = state;
+			
+			// Mix the tap into the outputs and the feedback
+			float gainLeft = gainsLeft_[t], gainRight = gainsRight_[t], gain = gains_[t];
+			for(unsigned int i = 0; i < run; i++) {
+				left[n + i] += tap[i] * gainLeft;
+				right[n + i] += tap[i] * gainRight;
+				feedback[i] += tap[i] * gain;
+			}
+		}
+		
+		// The input and feedback go into the delay line
+		for(unsigned int i = 0; i < run; i++)
+			feedback[i] = input[n + i] + feedbackGain_ * feedback[i];
+		delayLine_.write(feedback, run);
+		
+		n += run;
+	}
+}
@@ -0,0 +1,81 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// MultiTapDelay: up to kMaxTaps echoes read from one shared delay line.
+// Each tap has its own delay time, gain, stereo position and lowpass
+// filter, and the taps can be fed back into the delay line.
+//
+// The block is worked through in runs no longer than the shortest tap's
+// delay. Within a run nothing that is written can be read back, so each tap
+// copies its whole run out of the delay line at once and the filtering and
+// mixing are loops along the run. Unused taps have a gain of 0 and are
+// skipped.
+
+#pragma once
+
+#include "DelayLine.h"
+
+class MultiTapDelay {
+public:
+	// Most taps that can be used at once
+	static const unsigned int kMaxTaps = 16;
+	
+	// Longest run processed at once, which sets the size of the scratch
+	// buffers
+	static const unsigned int kMaxRun = 64;
+	
+	// Constructor
+	MultiTapDelay() {}
+	
+	// Make space for delays of up to maxDelay seconds and turn off all the taps
+	void setup(float maxDelay, float sampleRate);
+	
+	// Set one tap: its delay in seconds, gain, pan (0 = left, 1 = right)
+	// and lowpass filter cutoff in Hz
+	void setTap(unsigned int tap, float delay, float gain, float pan = 0.5,
+				float cutoff = 20000.0);
+	
+	// Turn off one tap
+	void clearTap(unsigned int tap);
+	
+	// Set how much of the taps' output goes back into the delay line, from
+	// 0 to just below 1. The taps are scaled by the total of their gains
+	// before being fed back, so the echoes always die away.
+	void setFeedback(float feedback);
+	
+	// Delay a block of input, writing the taps mixed to stereo
+	void process(const float *input, float *left, float *right, unsigned int frames);
+	
+	// Destructor
+	~MultiTapDelay() {}
+
+private:
+	DelayLine delayLine_;				// Buffer shared by all the taps
+	float sampleRate_ = 44100.0;
+	float feedback_ = 0;
+	float feedbackGain_ = 0;			// feedback_ divided by the total of the taps' gains
+	
+	unsigned int shortestDelay_ = 1;	// Shortest delay of a tap in use, in samples
+	
+	// Work out feedbackGain_ and shortestDelay_ after the feedback or a tap
+	// changes
+	void updateFeedbackGain();
+	void updateShortestDelay();
+	
+	// Settings and state for each tap
+	unsigned int delays_[kMaxTaps];		// Delay in samples
+	float gains_[kMaxTaps];				// Overall gain, used for feedback
+	float gainsLeft_[kMaxTaps];			// Gain to the left output, including pan
+	float gainsRight_[kMaxTaps];		// Gain to the right output, including pan
+	float filterCoefficients_[kMaxTaps];	// One-pole lowpass coefficient
+	float filterStates_[kMaxTaps];		// Last output of each lowpass filter
+};
@@ -0,0 +1,106 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+multitap-delay: a rhythmic pattern of echoes, all read from one circular buffer
+*/
+
+#include <Bela.h>
+#include <vector>
+#include <cmath>
+#include "MonoFilePlayer.h"
+#include "MultiTapDelay.h"
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+
+// Name of the sound file (in project folder)
+std::string gFilename = "slow-drum-loop.wav";
+
+// Object that handles playing sound from a buffer
+MonoFilePlayer gPlayer;
+
+// Bela slider Gui
+Gui gGui;
+GuiController gGuiController;
+
+// The delay, and blocks of samples going in and out of it
+MultiTapDelay gDelay;
+std::vector<float> gInputBuffer;
+std::vector<float> gLeftBuffer;
+std::vector<float> gRightBuffer;
+
+// Length of one beat of the echo pattern in seconds
+const float kBeatLength = 0.25;
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Load the audio file
+	if(!gPlayer.setup(gFilename)) {
+    	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
+    	return false;
+	}
+
+	// Print some useful info
+    rt_printf("Loaded the audio file '%s' with %d frames (%.1f seconds)\n", 
+    			gFilename.c_str(), gPlayer.size(),
+    			gPlayer.size() / context->audioSampleRate);
+    
+	// Make the delay long enough for all the taps, and set up a pattern of
+	// echoes on sixteenth notes that bounce between left and right, get
+	// quieter and get darker as they go
+	gDelay.setup(MultiTapDelay::kMaxTaps * kBeatLength / 4 + 0.1, context->audioSampleRate);
+	for(unsigned int tap = 0; tap < MultiTapDelay::kMaxTaps; tap++) {
+		float delay = (tap + 1) * kBeatLength / 4;
+		float gain = 0.6 * powf(0.85, tap);
+		float pan = (tap % 2) ? 0.1 : 0.9;
+		float cutoff = 8000.0 * powf(0.85, tap);
+		
+		// Leave out every third sixteenth for a more interesting rhythm
+		if(tap % 3 == 2)
+			continue;
+		gDelay.setTap(tap, delay, gain, pan, cutoff);
+	}
+	
+	// Make space for one block of input and output
+	gInputBuffer.resize(context->audioFrames);
+	gLeftBuffer.resize(context->audioFrames);
+	gRightBuffer.resize(context->audioFrames);
+	
+	// set up the Gui
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "Multi-tap Delay Controller");
+	
+	//args: name, default value, minimum, maximum, increment (no fixed increment)
+	gGuiController.addSlider("Feedback", 0.5, 0, 0.95, 0);
+	gGuiController.addSlider("Dry level", 0.7, 0, 1, 0);
+	 
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	gDelay.setFeedback(gGuiController.getSliderValue(0));
+	float dryLevel = gGuiController.getSliderValue(1);
+	
+    for(unsigned int n = 0; n < context->audioFrames; n++)
+    	gInputBuffer[n] = gPlayer.process();
+    
+    // Run all the taps for the whole block
+    gDelay.process(gInputBuffer.data(), gLeftBuffer.data(), gRightBuffer.data(), context->audioFrames);
+    
+    for(unsigned int n = 0; n < context->audioFrames; n++) {
+		// Mix the dry sound with the echoes in stereo
+    	audioWrite(context, n, 0, dryLevel * gInputBuffer[n] + gLeftBuffer[n]);
+    	audioWrite(context, n, 1, dryLevel * gInputBuffer[n] + gRightBuffer[n]);
+    }
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
@@ -0,0 +1,156 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// MultiChannelDelay.cpp: a delay with feedback across several channels
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "MultiChannelDelay.h"
+
+// Make space for the buffer and start with ping-pong feedback
+void MultiChannelDelay::setup(unsigned int numChannels, float maxDelay, float sampleRate)
+{
+	if(numChannels < 1)
+		numChannels = 1;
+	else if(numChannels > kMaxChannels)
+		numChannels = kMaxChannels;
+	numChannels_ = numChannels;
+	sampleRate_ = sampleRate;
+	
+	// Round the length up to a power of 2 so the pointer can wrap with a mask
+	unsigned int maxDelayInSamples = maxDelay * sampleRate;
+	unsigned int length = 2;
+	while(length <= maxDelayInSamples)
+		length *= 2;
+	buffer_.assign(length * kMaxChannels, 0);
+	mask_ = length - 1;
+	writePointer_ = 0;
+	
+	feedback_ = 0;
+	dampingCoefficient_ = 1.0;
+	setDelay(maxDelay);
+	setPingPong();
+	reset();
+}
+
+// Set the delay time, the same for every channel
+void MultiChannelDelay::setDelay(float delay)
+{
+	// Each frame is read before it is written, so the shortest delay is 1
+	unsigned int delayInSamples = delay * sampleRate_;
+	if(delayInSamples < 1)
+		delayInSamples = 1;
+	if(delayInSamples > mask_)
+		delayInSamples = mask_;
+	delay_ = delayInSamples;
+}
+
+// Set how much of the delayed signal is fed back
+void MultiChannelDelay::setFeedback(float feedback)
+{
+	if(feedback < 0)
+		feedback = 0;
+	else if(feedback > 0.99)
+		feedback = 0.99;
+	feedback_ = feedback;
+}
+
+// Set the cutoff of the lowpass filter in the feedback path
+void MultiChannelDelay::setDamping(float cutoff)
+{
+	// One-pole lowpass: y[n] = y[n-1] + c * (x[n] - y[n-1])
+	dampingCoefficient_ = 1.0 - expf(-2.0 * M_PI * cutoff / sampleRate_);
+	if(dampingCoefficient_ > 1.0)
+		dampingCoefficient_ = 1.0;
+}
+
+// Set the feedback matrix directly, given as matrix[out * numChannels + in]
+void MultiChannelDelay::setFeedbackMatrix(const float *matrix)
+{
+	// Channels that aren't in use get no feedback at all
+	memset(matrix_, 0, sizeof(matrix_));
+	for(unsigned int out = 0; out < numChannels_; out++) {
+		for(unsigned int in = 0; in < numChannels_; in++)
+			matrix_[in][out] = matrix[out * numChannels_ + in];
+	}
+}
+
+// Feed each channel back into itself
+void MultiChannelDelay::setStraight()
+{
+	memset(matrix_, 0, sizeof(matrix_));
+	for(unsigned int c = 0; c < numChannels_; c++)
+		matrix_[c][c] = 1.0;
+}
+
+// Feed each channel into the next one, and the last back into the first
+void MultiChannelDelay::setPingPong()
+{
+	memset(matrix_, 0, sizeof(matrix_));
+	for(unsigned int c = 0; c < numChannels_; c++)
+		matrix_[c][(c + 1) % numChannels_] = 1.0;
+}
+
+// Rotate each pair of channels by the given angle. A rotation keeps the
+// level the same, so only the feedback gain sets how quickly echoes die away.
+void MultiChannelDelay::setRotation(float angle)
+{
+	float c = cosf(angle);
+	float s = sinf(angle);
+	
+	setStraight();
+	for(unsigned int ch = 0; ch + 1 < numChannels_; ch += 2) {
+		matrix_[ch][ch] = c;
+		matrix_[ch + 1][ch] = -s;
+		matrix_[ch][ch + 1] = s;
+		matrix_[ch + 1][ch + 1] = c;
+	}
+}
+
+// Clear the buffer and filters
+void MultiChannelDelay::reset()
+{
+	std::fill(buffer_.begin(), buffer_.end(), 0);
+	for(unsigned int c = 0; c < kMaxChannels; c++)
+		filterStates_[c] = 0;
+}
+
+// Delay a block of audio with numChannels channels
+void MultiChannelDelay::process(const float *input, float *output, unsigned int frames)
+{
+	for(unsigned int n = 0; n < frames; n++) {
+		// One delayed frame holds every channel side by side
+		const float *delayed = &buffer_[((writePointer_ - delay_) & mask_) * kMaxChannels];
+		float *frame = &buffer_[(writePointer_ & mask_) * kMaxChannels];
+		
+		// Filter every channel, then mix them through the matrix. These
+		// loops always run across all kMaxChannels lanes.
+		float mixed[kMaxChannels] = {0};
+		for(unsigned int c = 0; c < kMaxChannels; c++)
+			filterStates_[c] += dampingCoefficient_ * (delayed[c] - filterStates_[c]);
+		for(unsigned int in = 0; in < kMaxChannels; in++) {
+			for(unsigned int out = 0; out < kMaxChannels; out++)
+				mixed[out] += matrix_[in][out] * filterStates_[in];
+		}
+		for(unsigned int c = 0; c < kMaxChannels; c++)
+			frame[c] = feedback_ * mixed[c];
+		
+		// The input goes into the delay and the delayed signal comes out
+		for(unsigned int c = 0; c < numChannels_; c++) {
+			frame[c] += input[c * frames + n];
+			output[c * frames + n] = delayed[c];
+		}
+		
+		writePointer_++;
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// MultiChannelDelay: a delay for 2 to kMaxChannels channels whose echoes
+// feed back across the channels through a mixing matrix. With the right
+// matrix the echoes bounce from one channel to the next (ping-pong), or
+// gradually rotate around the channels.
+//
+// All the channels share one circular buffer, stored frame by frame with
+// kMaxChannels samples in each frame. Reading one delayed frame gives the
+// samples for every channel side by side, so the filtering and mixing are
+// short loops across the channels that the compiler can vectorise. Unused
+// channels are kept at zero, so 8 channels cost about the same as 2.
+
+#pragma once
+
+#include <vector>
+
+class MultiChannelDelay {
+public:
+	// Most channels that can be used at once
+	static const unsigned int kMaxChannels = 8;
+
+	// Constructor
+	MultiChannelDelay() {}
+
+	// Make space for delays of up to maxDelay seconds on the given number
+	// of channels. The feedback starts as ping-pong.
+	void setup(unsigned int numChannels, float maxDelay, float sampleRate);
+
+	// Return the number of channels
+	unsigned int getNumChannels() { return numChannels_; }
+
+	// Set the delay time in seconds, the same for every channel
+	void setDelay(float delay);
+
+	// Set how much of the delayed signal is fed back, from 0 to just below
+	// 1 so that the echoes always die away
+	void setFeedback(float feedback);
+
+	// Set the cutoff of the lowpass filter in the feedback path, in Hz
+	void setDamping(float cutoff);
+
+	// Set the feedback matrix directly: matrix[out * numChannels + in] is
+	// how much of channel in is fed back into channel out
+	void setFeedbackMatrix(const float *matrix);
+
+	// Feed each channel's echoes straight back into the same channel
+	void setStraight();
+
+	// Feed each channel's echoes into the next channel, going round in a circle
+	void setPingPong();
+
+	// Rotate neighbouring pairs of channels by the given angle in radians
+	// each time round: 0 is the same as setStraight(), and pi/2 swaps the
+	// channels in each pair like ping-pong (with one side inverted)
+	void setRotation(float angle);
+
+	// Clear the buffer and filters
+	void reset();
+
+	// Delay a block of audio. input and output hold numChannels channels one
+	// after the other, each frames samples long. This is not the same as
+	// Bela's audio buffers, which are interleaved (all the channels of one
+	// frame, then the next frame) unless the non-interleaved flag is set.
+	void process(const float *input, float *output, unsigned int frames);
+
+	// Destructor
+	~MultiChannelDelay() {}
+
+private:
+	std::vector<float> buffer_;		// Circular buffer of frames, kMaxChannels samples each
+	unsigned int mask_ = 0;			// Number of frames in the buffer - 1
+	unsigned int writePointer_ = 0;	// Next frame to write
+	unsigned int delay_ = 1;		// Delay in frames
+
+	unsigned int numChannels_ = 2;
+	float sampleRate_ = 44100.0;
+	float feedback_ = 0;
+	float dampingCoefficient_ = 1.0;
+
+	// Feedback matrix, stored with the input channel first so that the
+	// loop across output channels goes through memory in order
+	float matrix_[kMaxChannels][kMaxChannels];
+
+	// Last output of the lowpass filter in each channel
+	float filterStates_[kMaxChannels];
+};
@@ -0,0 +1,111 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+pingpong-delay: echoes that bounce between the output channels
+*/
+
+#include <Bela.h>
+#include <vector>
+#include <cmath>
+#include "MonoFilePlayer.h"
+#include "MultiChannelDelay.h"
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+
+// Name of the sound file (in project folder)
+std::string gFilename = "slow-drum-loop.wav";
+
+// Object that handles playing sound from a buffer
+MonoFilePlayer gPlayer;
+
+// Bela slider Gui
+Gui gGui;
+GuiController gGuiController;
+
+// The delay, and blocks of samples going in and out of it. Each block
+// holds all the channels one after the other.
+MultiChannelDelay gDelay;
+std::vector<float> gInputBuffer;
+std::vector<float> gOutputBuffer;
+std::vector<float> gDryBuffer;
+
+// Longest delay time in seconds
+const float kMaxDelay = 2.0;
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Load the audio file
+	if(!gPlayer.setup(gFilename)) {
+    	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
+    	return false;
+	}
+
+	// Print some useful info
+    rt_printf("Loaded the audio file '%s' with %d frames (%.1f seconds)\n", 
+    			gFilename.c_str(), gPlayer.size(),
+    			gPlayer.size() / context->audioSampleRate);
+    
+	// Use every output channel, up to the most the delay can handle
+	unsigned int numChannels = context->audioOutChannels;
+	if(numChannels > MultiChannelDelay::kMaxChannels)
+		numChannels = MultiChannelDelay::kMaxChannels;
+	gDelay.setup(numChannels, kMaxDelay, context->audioSampleRate);
+	gDelay.setDamping(5000.0);
+	
+	// Make space for one block of every channel. Only the first channel
+	// gets any input, so the echoes start there and bounce around.
+	gInputBuffer.assign(context->audioFrames * numChannels, 0);
+	gOutputBuffer.resize(context->audioFrames * numChannels);
+	gDryBuffer.resize(context->audioFrames);
+	
+	// set up the Gui
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "Ping-pong Delay Controller");
+	
+	//args: name, default value, minimum, maximum, increment (no fixed increment)
+	gGuiController.addSlider("Delay", 0.375, 0.01, kMaxDelay, 0);
+	gGuiController.addSlider("Feedback", 0.6, 0, 0.95, 0);
+	gGuiController.addSlider("Ping-pong (0) or rotation (1)", 0, 0, 1, 1);
+	gGuiController.addSlider("Rotation angle", 45, 0, 90, 0);
+	gGuiController.addSlider("Dry level", 0.7, 0, 1, 0);
+	 
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	gDelay.setDelay(gGuiController.getSliderValue(0));
+	gDelay.setFeedback(gGuiController.getSliderValue(1));
+	if(gGuiController.getSliderValue(2) < 0.5)
+		gDelay.setPingPong();
+	else
+		gDelay.setRotation(gGuiController.getSliderValue(3) * M_PI / 180.0);
+	float dryLevel = gGuiController.getSliderValue(4);
+	
+    for(unsigned int n = 0; n < context->audioFrames; n++) {
+    	gDryBuffer[n] = gPlayer.process();
+    	gInputBuffer[n] = gDryBuffer[n];
+    }
+    
+    // Run every channel of the delay for the whole block
+    gDelay.process(gInputBuffer.data(), gOutputBuffer.data(), context->audioFrames);
+    
+    for(unsigned int channel = 0; channel < gDelay.getNumChannels(); channel++) {
+    	const float *echoes = &gOutputBuffer[channel * context->audioFrames];
+    	for(unsigned int n = 0; n < context->audioFrames; n++) {
+			// Mix the dry sound into every channel with the echoes
+    		audioWrite(context, n, channel, dryLevel * gDryBuffer[n] + echoes[n]);
+    	}
+    }
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
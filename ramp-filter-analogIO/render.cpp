@@ -15,6 +15,7 @@ ramp-filter: linear envelope to control the frequency of a resonant filter
 #include <cmath>
 #include "Wavetable.h"
 #include "Filter.h"
+#include "SmoothedParameter.h"
 
 // Pins for analog I/O 
 const unsigned int kInputDuration = 0;
@@ -24,12 +25,18 @@ const unsigned int kInputOscillatorFrequency = 2;
 // Variables for linear envelope
 float gRampDuration = 2.0;
 float gFilterFrequencyMin = 200.0;
-float gFilterFrequencyMax = 4000.0;
 float gFilterFrequency = gFilterFrequencyMin;  
-float gFilterFrequencyIncrement = 0;
 
-// Oscillator frequency
-const float gOscillatorFrequency = 110.0;
+// The analog inputs are read and converted to parameters once every
+// kControlInterval samples, with the parameters smoothed in between
+const unsigned int kControlInterval = 16;
+SmoothedParameter gFilterFrequencyMax;
+SmoothedParameter gFilterFrequencyIncrement;
+SmoothedParameter gOscillatorFrequency;
+
+// Starting values for the parameters controlled by the inputs
+const float kFilterFrequencyMax = 4000.0;
+const float kOscillatorFrequency = 110.0;
 
 // Oscillator and filter objects
 Wavetable gOscillator;
@@ -60,16 +67,22 @@ bool setup(BelaContext *context, void *userData)
 	
 	// Initialise the wavetable, passing the sample rate and the buffer
 	gOscillator.setup(context->audioSampleRate, wavetable);
-	gOscillator.setFrequency(gOscillatorFrequency);
+	gOscillator.setFrequency(kOscillatorFrequency);
 	
 	// Initialise the filter
 	gFilter.setSampleRate(context->audioSampleRate);
 	gFilter.setFrequency(gFilterFrequencyMin);
 	gFilter.setQ(4.0);
 	
-	// TODO: calculate ramp increment
+	// Start the smoothed parameters at their first values. The increment
+	// takes the filter from its minimum to its maximum over gRampDuration.
 	float rampDuration = gRampDuration * context->audioSampleRate;
-	gFilterFrequencyIncrement = (gFilterFrequencyMax - gFilterFrequencyMin) / rampDuration;
+	gFilterFrequencyMax.setup(kControlInterval);
+	gFilterFrequencyIncrement.setup(kControlInterval);
+	gOscillatorFrequency.setup(kControlInterval);
+	gFilterFrequencyMax.setValue(kFilterFrequencyMax);
+	gFilterFrequencyIncrement.setValue((kFilterFrequencyMax - gFilterFrequencyMin) / rampDuration);
+	gOscillatorFrequency.setValue(kOscillatorFrequency);
 	
     return true;
 }
@@ -80,23 +93,29 @@ void render(BelaContext *context, void *userData)
    	// This for() loop goes through all the samples in the block
 	for (unsigned int n = 0; n < context->audioFrames; n++) {
 		
-		//read the analog inputs 
-		float durationInput = analogRead(context, n/2, kInputDuration);
-		float maxFrequencyInput = analogRead(context, n/2, kInputMaxFrequency);
-		float oscillatorInput = analogRead(context, n/2, kInputOscillatorFrequency);
-		
-		// recalculate the interval based on the input controls
-		gFilterFrequencyMax = map(maxFrequencyInput, 0, 3.3/4.096, 400.0, 8000.0);
-		gRampDuration = map(durationInput, 0, 3.3/4.096, 0.05, 5.0);
-		gFilterFrequencyIncrement = (gFilterFrequencyMax - gFilterFrequencyMin) / (gRampDuration * context->audioSampleRate);
+		// All the parameters share the same interval, so they are due together
+		if(gOscillatorFrequency.needsUpdate()) {
+			//read the analog inputs 
+			float durationInput = analogRead(context, n/2, kInputDuration);
+			float maxFrequencyInput = analogRead(context, n/2, kInputMaxFrequency);
+			float oscillatorInput = analogRead(context, n/2, kInputOscillatorFrequency);
+			
+			// recalculate the interval based on the input controls
+			float filterFrequencyMax = map(maxFrequencyInput, 0, 3.3/4.096, 400.0, 8000.0);
+			gRampDuration = map(durationInput, 0, 3.3/4.096, 0.05, 5.0);
+			gFilterFrequencyMax.setTarget(filterFrequencyMax);
+			gFilterFrequencyIncrement.setTarget((filterFrequencyMax - gFilterFrequencyMin) / (gRampDuration * context->audioSampleRate));
+			
+			// recalculate the osc freq 
+			gOscillatorFrequency.setTarget(map(oscillatorInput, 0, 3.3/4.096, 40.0, 500.0));
+		}
 		
-		// recalculate and set the osc freq 
-		float oscillatorFrequency = map(oscillatorInput, 0, 3.3/4.096, 40.0, 500.0);
-		gOscillator.setFrequency(oscillatorFrequency);
+		// set the osc freq from its smoothed value
+		gOscillator.setFrequency(gOscillatorFrequency.process());
 		
 		// increment the frequency to create a linear ramp
-		gFilterFrequency += gFilterFrequencyIncrement;
-		if(gFilterFrequency >= gFilterFrequencyMax)
+		gFilterFrequency += gFilterFrequencyIncrement.process();
+		if(gFilterFrequency >= gFilterFrequencyMax.process())
 			gFilterFrequency = gFilterFrequencyMin;
 		
 		// Update the filter frequency
@@ -0,0 +1,272 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 12: Envelopes
+*/
+
+// BreakpointEnvelope.cpp: a multi-segment envelope generator. The shape of
+// each segment is read from lookup tables shared by every envelope, so no
+// pow() or exp() calls are needed while it runs.
+
+#include <cmath>
+#include "BreakpointEnvelope.h"
+
+// Storage for the shared lookup tables
+float BreakpointEnvelope::curveTables_[kNumCurveTables][kCurveTableSize + 1];
+bool BreakpointEnvelope::curveTablesReady_ = false;
+constexpr float BreakpointEnvelope::kMaxCurve;
+
+// Constructor
+BreakpointEnvelope::BreakpointEnvelope() : BreakpointEnvelope(1) {}
+
+// Constructor specifying a sample rate
+BreakpointEnvelope::BreakpointEnvelope(float sampleRate)
+{
+	if(!curveTablesReady_)
+		makeCurveTables();
+	
+	sampleRate_ = sampleRate;
+	startLevel_ = 0;
+	loopStart_ = loopEnd_ = -1;
+	sustainPoint_ = -1;
+	
+	currentSegment_ = -1;
+	released_ = false;
+	currentValue_ = 0;
+	segmentStart_ = segmentDistance_ = 0;
+	curve_ = curveTables_[kNumCurveTables / 2];
+	phase_ = phaseIncrement_ = 0;
+	counter_ = 0;
+}
+
+// Fill the lookup tables. Each row goes from 0 to 1 with a different curve.
+void BreakpointEnvelope::makeCurveTables()
+{
+	for(unsigned int row = 0; row < kNumCurveTables; row++) {
+		float curve = kMaxCurve * (2.0 * row / (kNumCurveTables - 1) - 1.0);
+		for(unsigned int n = 0; n <= kCurveTableSize; n++) {
+			float x = (float)n / (float)kCurveTableSize;
+			if(fabsf(curve) < 0.001)
+				curveTables_[row][n] = x;
+			else
+				curveTables_[row][n] = (1.0 - expf(curve * x)) / (1.0 - expf(curve));
+		}
+	}
+	curveTablesReady_ = true;
+}
+
+// Set the sample rate, used for all calculations
+void BreakpointEnvelope::setSampleRate(float rate)
+{
+	sampleRate_ = rate;
+}
+
+// Set the level the envelope starts from
+void BreakpointEnvelope::setStartLevel(float level)
+{
+	startLevel_ = level;
+	if(currentSegment_ < 0)
+		currentValue_ = level;
+}
+
+// Remove all the segments and stop the envelope
+void BreakpointEnvelope::clear()
+{
+	segments_.clear();
+	loopStart_ = loopEnd_ = -1;
+	sustainPoint_ = -1;
+	currentSegment_ = -1;
+	counter_ = 0;
+}
+
+// Add a segment to the end of the envelope
+void BreakpointEnvelope::addSegment(float level, float time, float curve)
+{
+	Segment segment;
+	segment.level = level;
+	segment.time = (time >= 0) ? time : 0;
+	if(curve > kMaxCurve)
+		curve = kMaxCurve;
+	else if(curve < -kMaxCurve)
+		curve = -kMaxCurve;
+	segment.curve = curve;
+	segments_.push_back(segment);
+}
+
+// Set the segments to repeat until release
+void BreakpointEnvelope::setLoopPoints(int startSegment, int endSegment)
+{
+	if(startSegment < 0 || endSegment < startSegment || endSegment >= (int)segments_.size())
+		loopStart_ = loopEnd_ = -1;
+	else {
+		loopStart_ = startSegment;
+		loopEnd_ = endSegment;
+	}
+}
+
+// Set the segment to hold at until release
+void BreakpointEnvelope::setSustainPoint(int segment)
+{
+	if(segment < 0 || segment >= (int)segments_.size())
+		sustainPoint_ = -1;
+	else
+		sustainPoint_ = segment;
+}
+
+// Start the envelope from the first segment
+void BreakpointEnvelope::trigger()
+{
+	released_ = false;
+	currentValue_ = startLevel_;
+	if(segments_.empty()) {
+		currentSegment_ = -1;
+		return;
+	}
+	startSegment(0);
+}
+
+// Leave the loop or sustain point
+void BreakpointEnvelope::release()
+{
+	if(released_ || currentSegment_ < 0)
+		return;
+	released_ = true;
+	
+	// Jump to the first segment after the loop or sustain point,
+	// starting from wherever we are now
+	int lastHeldSegment = (loopEnd_ > sustainPoint_) ? loopEnd_ : sustainPoint_;
+	if(lastHeldSegment < 0 || currentSegment_ > lastHeldSegment)
+		return;	// Nothing is held, or we are already past it
+	
+	if(lastHeldSegment + 1 < (int)segments_.size())
+		startSegment(lastHeldSegment + 1);
+	else {
+		// Nothing after the held part: stop where we are
+		currentSegment_ = -1;
+		counter_ = 0;
+	}
+}
+
+// Begin playing a segment from the current level
+void BreakpointEnvelope::startSegment(unsigned int segment)
+{
+	const Segment& s = segments_[segment];
+	
+	currentSegment_ = segment;
+	segmentStart_ = currentValue_;
+	segmentDistance_ = s.level - currentValue_;
+	
+	// Pick the lookup table closest to the requested curve
+	int row = roundf((s.curve / kMaxCurve + 1.0) * 0.5 * (kNumCurveTables - 1));
+	curve_ = curveTables_[row];
+	
+	// Count the length of the segment in samples
+	counter_ = (int)(s.time * sampleRate_);
+	phase_ = 0;
+	phaseIncrement_ = (counter_ > 0) ? (float)kCurveTableSize / (float)counter_ : 0;
+	
+	if(counter_ == 0) {
+		// Zero-length segment: jump straight to the level
+		currentValue_ = s.level;
+		nextSegment();
+	}
+}
+
+// Go to the next segment once the current one has finished
+void BreakpointEnvelope::nextSegment()
+{
+	// Land exactly on the breakpoint
+	currentValue_ = segments_[currentSegment_].level;
+	
+	if(!released_) {
+		if(currentSegment_ == loopEnd_) {
+			// Only loop if the loop takes some time, so we can't get stuck here
+			int loopLength = 0;
+			for(int i = loopStart_; i <= loopEnd_; i++)
+				loopLength += (int)(segments_[i].time * sampleRate_);
+			if(loopLength > 0) {
+				startSegment(loopStart_);
+				return;
+			}
+		}
+		if(currentSegment_ == sustainPoint_)
+			return;	// Hold here: counter_ stays at 0 until release()
+	}
+	
+	if(currentSegment_ + 1 < (int)segments_.size())
+		startSegment(currentSegment_ + 1);
+	else
+		currentSegment_ = -1;	// Reached the end
+}
+
+// Generate and return the next envelope output
+float BreakpointEnvelope::process()
+{
+	float out = currentValue_;
+	
+	if(counter_ > 0) {
+		// Advance through the lookup table with linear interpolation
+		phase_ += phaseIncrement_;
+		int index = (int)phase_;
+		if(index >= (int)kCurveTableSize)
+			index = kCurveTableSize - 1;
+		float fraction = phase_ - index;
+		float shape = curve_[index] + fraction * (curve_[index + 1] - curve_[index]);
+		currentValue_ = segmentStart_ + segmentDistance_ * shape;
+		
+		if(--counter_ == 0)
+			nextSegment();
+	}
+	
+	return out;
+}
+
+// Generate the next block of envelope output
+void BreakpointEnvelope::process(float *output, unsigned int frames)
+{
+	unsigned int n = 0;
+	while(n < frames) {
+		if(counter_ == 0) {
+			// Holding or stopped: the value doesn't change
+			for(; n < frames; n++)
+				output[n] = currentValue_;
+			break;
+		}
+		
+		// Run to the end of the segment or the end of the block,
+		// whichever comes first, without checking anything else
+		unsigned int run = frames - n;
+		if(run > (unsigned int)counter_)
+			run = counter_;
+		float phase = phase_;
+		float value = currentValue_;
+		for(unsigned int end = n + run; n < end; n++) {
+			output[n] = value;
+			phase += phaseIncrement_;
+			int index = (int)phase;
+			if(index >= (int)kCurveTableSize)
+				index = kCurveTableSize - 1;
+			float fraction = phase - index;
+			float shape = curve_[index] + fraction * (curve_[index + 1] - curve_[index]);
+			value = segmentStart_ + segmentDistance_ * shape;
+		}
+		phase_ = phase;
+		currentValue_ = value;
+		
+		counter_ -= run;
+		if(counter_ == 0)
+			nextSegment();
+	}
+}
+
+// Indicate whether the envelope is running
+bool BreakpointEnvelope::isActive()
+{
+	return (currentSegment_ >= 0);
+}
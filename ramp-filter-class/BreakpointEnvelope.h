@@ -0,0 +1,116 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 12: Envelopes
+*/
+
+// BreakpointEnvelope.h: an envelope made of any number of curved segments,
+// with optional loop and sustain points
+
+#pragma once
+
+#include <vector>
+
+class BreakpointEnvelope {
+private:
+	// One segment of the envelope, going from the end of the previous
+	// segment to this level
+	struct Segment {
+		float level;		// Level at the end of the segment
+		float time;			// Duration in seconds
+		float curve;		// 0 for a straight line, > 0 starts slowly, < 0 starts quickly
+	};
+
+public:
+	// Range of curve values and resolution of the curve lookup tables
+	static constexpr float kMaxCurve = 8.0;
+	static const unsigned int kCurveTableSize = 256;
+	static const unsigned int kNumCurveTables = 65;
+
+	// Constructor
+	BreakpointEnvelope();
+
+	// Constructor specifying a sample rate
+	BreakpointEnvelope(float sampleRate);
+
+	// Set the sample rate, used for all calculations
+	void setSampleRate(float rate);
+
+	// Set the level the envelope starts from and rests at before it is triggered
+	void setStartLevel(float level);
+
+	// Remove all the segments and stop the envelope
+	void clear();
+
+	// Add a segment to the end of the envelope, going to the given level
+	// over the given time. The curve ranges from -kMaxCurve to kMaxCurve.
+	void addSegment(float level, float time, float curve = 0);
+
+	// Return the number of segments
+	unsigned int size() { return segments_.size(); }
+
+	// Repeat segments startSegment to endSegment (inclusive) until
+	// release() is called. Pass -1 to turn looping off.
+	void setLoopPoints(int startSegment, int endSegment);
+
+	// Hold at the end of this segment until release() is called.
+	// Pass -1 for no sustain point.
+	void setSustainPoint(int segment);
+
+	// Start the envelope from the first segment
+	void trigger();
+
+	// Leave the sustain point or loop and go on to the segments after it
+	void release();
+
+	// Generate and return the next envelope output
+	float process();
+
+	// Generate the next block of envelope output
+	void process(float *output, unsigned int frames);
+
+	// Indicate whether the envelope is running or holding at a sustain point
+	bool isActive();
+
+	// Destructor
+	~BreakpointEnvelope() {}
+
+private:
+	// Begin playing the given segment from the current level
+	void startSegment(unsigned int segment);
+
+	// Go on from the segment that just finished, looping or holding as needed
+	void nextSegment();
+
+	// Fill the curve lookup tables, shared by all envelopes
+	static void makeCurveTables();
+
+	// Curve lookup tables: one row per curve value, from -kMaxCurve to kMaxCurve
+	static float curveTables_[kNumCurveTables][kCurveTableSize + 1];
+	static bool curveTablesReady_;
+
+	// Parameters
+	float sampleRate_;
+	float startLevel_;
+	std::vector<Segment> segments_;
+	int loopStart_;
+	int loopEnd_;
+	int sustainPoint_;
+
+	// State variables
+	int currentSegment_;			// Segment we are in, or -1 if not running
+	bool released_;					// Whether release() has been called since trigger()
+	float currentValue_;
+	float segmentStart_;			// Level at the start of the current segment
+	float segmentDistance_;			// How far the current segment travels
+	const float *curve_;			// Lookup table for the current segment
+	float phase_;					// Position in the lookup table
+	float phaseIncrement_;
+	int counter_;					// Samples left in the current segment
+};
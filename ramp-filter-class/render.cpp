@@ -16,7 +16,7 @@ ramp-filter-class: resonant filter controlled by a linear envelope, using a clas
 #include <cmath>
 #include "Wavetable.h"
 #include "Filter.h"
-#include "Ramp.h"
+#include "BreakpointEnvelope.h"
 
 // Variables for linear envelope
 const float kRampDurationUp = 2.0;
@@ -24,16 +24,16 @@ const float kRampDurationDown = 2.0;
 const float kFilterFrequencyMin = 200.0;
 const float kFilterFrequencyMax = 4000.0;
 
-// state var for multiple segments
-bool gRampIncreasing = true;
-
 // Oscillator frequency
 const float kOscillatorFrequency = 110.0;
 
 // Oscillator and filter objects
 Wavetable gOscillator;
 Filter gFilter;
-Ramp gRamp;
+BreakpointEnvelope gEnvelope;
+
+// Buffer holding one block of envelope output
+std::vector<float> gEnvelopeBuffer;
 
 // Bela oscilloscope
 Scope gScope;
@@ -63,9 +63,14 @@ bool setup(BelaContext *context, void *userData)
 	gFilter.setFrequency(kFilterFrequencyMin);
 	gFilter.setQ(4.0);
 	
-	// Initialise the line segment object
-	gRamp.setSampleRate(context->audioSampleRate);
-	gRamp.setValue(kFilterFrequencyMin);
+	// Initialise the envelope: ramp up then down, looping forever
+	gEnvelope.setSampleRate(context->audioSampleRate);
+	gEnvelope.setStartLevel(kFilterFrequencyMin);
+	gEnvelope.addSegment(kFilterFrequencyMax, kRampDurationUp);
+	gEnvelope.addSegment(kFilterFrequencyMin, kRampDurationDown);
+	gEnvelope.setLoopPoints(0, 1);
+	gEnvelope.trigger();
+	gEnvelopeBuffer.resize(context->audioFrames);
 	
 	// Initialise the scope
 	gScope.setup(1, context->audioSampleRate);
@@ -76,27 +81,13 @@ bool setup(BelaContext *context, void *userData)
 // render() is called every time there is a new block to calculate
 void render(BelaContext *context, void *userData)
 {
+	// Calculate the filter frequency for the whole block at once
+	gEnvelope.process(gEnvelopeBuffer.data(), context->audioFrames);
+	
    	// This for() loop goes through all the samples in the block
 	for (unsigned int n = 0; n < context->audioFrames; n++) {
-		// Get the next filter frequency 
-		// from the ramp.h class 
-		float frequency = gRamp.process();
-		
-		// Check if we need to reset the ramp
-		// also from the ramp class 
-		if(gRamp.finished()) {
-			if(gRampIncreasing) {
-				//if we're increasing, ramp down to the min 
-				gRamp.rampTo(kFilterFrequencyMin, kRampDurationDown);
-			}
-			else {
-				//if decreasing, ramp up to the max 
-				gRamp.rampTo(kFilterFrequencyMax, kRampDurationUp);
-			}
-			
-			//Invert the state of whether we are increasing or decreasing
-			gRampIncreasing = !gRampIncreasing;
-		}
+		// Get the next filter frequency from the envelope
+		float frequency = gEnvelopeBuffer[n];
 		
 		// Update the filter frequency
 		gFilter.setFrequency(frequency);
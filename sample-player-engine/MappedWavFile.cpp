@@ -0,0 +1,228 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// MappedWavFile.cpp: read the samples of a WAV file in place, using mmap()
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdint>
+#include "MappedWavFile.h"
+
+// WAV format codes
+const unsigned int kWavFormatPcm = 1;
+const unsigned int kWavFormatFloat = 3;
+const unsigned int kWavFormatExtensible = 0xFFFE;
+
+// Read little-endian numbers from any position in the file
+static unsigned int readUint16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned int readUint32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// Constructor taking the path of a file to map
+MappedWavFile::MappedWavFile(const std::string& filename)
+{
+	open(filename);
+}
+
+// Map the file into memory and find the samples
+bool MappedWavFile::open(const std::string& filename)
+{
+	close();
+	
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+	
+	struct stat fileInfo;
+	if(fstat(fd, &fileInfo) != 0 || fileInfo.st_size < 12) {
+		::close(fd);
+		return false;
+	}
+	
+	// The mapping stays valid after the file is closed
+	mappingSize_ = fileInfo.st_size;
+	mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(mapping_ == MAP_FAILED) {
+		mapping_ = nullptr;
+		mappingSize_ = 0;
+		return false;
+	}
+	
+	if(!parse()) {
+		close();
+		return false;
+	}
+	
+	// Ask for the samples to be read ahead, then make sure they are all in
+	// memory before playback starts. Reading a page that isn't there yet
+	// would stop the audio thread while the disk is read, which on Bela
+	// also switches it out of real-time mode and causes a dropout.
+	madvise(mapping_, mappingSize_, MADV_SEQUENTIAL);
+	madvise(mapping_, mappingSize_, MADV_WILLNEED);
+	lockPages();
+	
+	return true;
+}
+
+// Load every page of the sample data and keep it in memory
+void MappedWavFile::lockPages()
+{
+	// mlock() works on whole pages, so start from the page the data starts in
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t dataStart = data_ - (const unsigned char *)mapping_;
+	size_t lockStart = dataStart - dataStart % pageSize;
+	size_t lockLength = dataStart + (size_t)frames_ * bytesPerSample_ * channels_ - lockStart;
+	
+	// Locking reads in the pages and stops them being dropped later
+	isLocked_ = (mlock((const unsigned char *)mapping_ + lockStart, lockLength) == 0);
+	if(isLocked_)
+		return;
+	
+	// If we aren't allowed to lock that much memory, at least read every
+	// page now so that they start off in memory
+	volatile unsigned char sum = 0;
+	for(size_t offset = lockStart; offset < lockStart + lockLength; offset += pageSize)
+		sum += ((const unsigned char *)mapping_)[offset];
+}
+
+// Find the fmt and data chunks
+bool MappedWavFile::parse()
+{
+	const unsigned char *file = (const unsigned char *)mapping_;
+	if(memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+		return false;
+	
+	bool foundFormat = false;
+	size_t position = 12;
+	
+	// Step through the chunks, each of which has a 4-byte ID and 4-byte size.
+	// Sizes are compared with the bytes left rather than added to the
+	// position, so a corrupt size can't wrap around past the end.
+	while(position + 8 <= mappingSize_) {
+		const unsigned char *chunk = file + position;
+		size_t chunkSize = readUint32(chunk + 4);
+		const unsigned char *body = chunk + 8;
+		size_t remaining = mappingSize_ - position - 8;
+		
+		if(memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= remaining) {
+			unsigned int formatCode = readUint16(body);
+			channels_ = readUint16(body + 2);
+			sampleRate_ = readUint32(body + 4);
+			unsigned int bitsPerSample = readUint16(body + 14);
+			
+			// Extensible files keep the real format code in the sub-format
+			if(formatCode == kWavFormatExtensible && chunkSize >= 26)
+				formatCode = readUint16(body + 24);
+			
+			if(formatCode == kWavFormatPcm && bitsPerSample == 16)
+				format_ = FormatInt16;
+			else if(formatCode == kWavFormatPcm && bitsPerSample == 24)
+				format_ = FormatInt24;
+			else if(formatCode == kWavFormatPcm && bitsPerSample == 32)
+				format_ = FormatInt32;
+			else if(formatCode == kWavFormatFloat && bitsPerSample == 32)
+				format_ = FormatFloat32;
+			else
+				return false;	// Not a format we can read in place
+			
+			bytesPerSample_ = bitsPerSample / 8;
+			foundFormat = (channels_ > 0);
+		}
+		else if(memcmp(chunk, "data", 4) == 0 && foundFormat) {
+			// Some programs write a bigger size than the file, so don't trust it
+			if(chunkSize > remaining)
+				chunkSize = remaining;
+			data_ = body;
+			frames_ = chunkSize / (bytesPerSample_ * channels_);
+			return true;
+		}
+		
+		// Chunks are padded to an even number of bytes
+		if(chunkSize >= remaining)
+			break;
+		position += 8 + chunkSize + (chunkSize & 1);
+	}
+	
+	return false;
+}
+
+// Unmap the file
+void MappedWavFile::close()
+{
+	if(mapping_)
+		munmap(mapping_, mappingSize_);
+	mapping_ = nullptr;
+	mappingSize_ = 0;
+	data_ = nullptr;
+	isLocked_ = false;
+	frames_ = channels_ = sampleRate_ = 0;
+}
+
+// Return a pointer to float samples that can be read in place
+const float *MappedWavFile::getFloatData(unsigned int channel)
+{
+	if(!data_ || format_ != FormatFloat32 || channel >= channels_)
+		return nullptr;
+	
+	// The data is only usable directly if it lines up with 4-byte boundaries
+	if(((uintptr_t)data_ & 3) != 0)
+		return nullptr;
+	return (const float *)data_ + channel;
+}
+
+// Convert a range of frames of one channel to floats
+void MappedWavFile::read(unsigned int channel, unsigned int start, unsigned int count, float *output)
+{
+	if(start >= frames_)
+		count = 0;
+	else if(count > frames_ - start)
+		count = frames_ - start;
+	
+	unsigned int frameSize = bytesPerSample_ * channels_;
+	const unsigned char *p = data_ + (size_t)start * frameSize + channel * bytesPerSample_;
+	
+	if(format_ == FormatInt16) {
+		for(unsigned int n = 0; n < count; n++, p += frameSize) {
+			int16_t sample;
+			memcpy(&sample, p, 2);
+			output[n] = sample * (1.0f / 32768.0f);
+		}
+	}
+	else if(format_ == FormatInt24) {
+		for(unsigned int n = 0; n < count; n++, p += frameSize) {
+			// Put the 3 bytes at the top of a 32-bit integer to keep the sign
+			int32_t sample = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+			output[n] = sample * (1.0f / 2147483648.0f);
+		}
+	}
+	else if(format_ == FormatInt32) {
+		for(unsigned int n = 0; n < count; n++, p += frameSize) {
+			int32_t sample;
+			memcpy(&sample, p, 4);
+			output[n] = sample * (1.0f / 2147483648.0f);
+		}
+	}
+	else {
+		for(unsigned int n = 0; n < count; n++, p += frameSize)
+			memcpy(&output[n], p, 4);
+	}
+}
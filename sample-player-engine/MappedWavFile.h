@@ -0,0 +1,88 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// MappedWavFile: gives direct access to the samples of an uncompressed WAV
+// file by mapping it into memory instead of reading it. Nothing is copied
+// when the file is opened, and several players of the same file share the
+// same pages. The pages holding the samples are locked into memory when the
+// file is opened, so reading them never has to wait for the disk.
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+class MappedWavFile {
+public:
+	// Sample formats that can be read
+	enum Format {
+		FormatInt16 = 0,
+		FormatInt24,
+		FormatInt32,
+		FormatFloat32
+	};
+
+	// Constructors: the one with arguments automatically calls open()
+	MappedWavFile() {}
+	MappedWavFile(const std::string& filename);
+	
+	// Map a WAV file into memory. Returns false if the file can't be opened
+	// or isn't 16, 24 or 32-bit PCM or 32-bit float.
+	bool open(const std::string& filename);
+	
+	// Unmap the file
+	void close();
+	
+	// Return information about the file
+	bool isOpen() { return data_ != nullptr; }
+	unsigned int getNumFrames() { return frames_; }
+	unsigned int getNumChannels() { return channels_; }
+	unsigned int getSampleRate() { return sampleRate_; }
+	Format getFormat() { return format_; }
+	
+	// Return whether the samples are locked in memory. If not (because the
+	// file is bigger than the locked memory limit), they were read in when
+	// the file was opened but may be dropped again if memory runs short.
+	bool isLocked() { return isLocked_; }
+	
+	// Return a pointer to one channel of a float file, which can be read
+	// directly with a step of getNumChannels() between frames. Returns
+	// nullptr if the samples are not floats or can't be read in place.
+	const float *getFloatData(unsigned int channel);
+	
+	// Convert count frames of one channel starting at frame start to floats
+	void read(unsigned int channel, unsigned int start, unsigned int count, float *output);
+	
+	// Destructor
+	~MappedWavFile() { close(); }
+	
+	// A mapping can't be copied, as both copies would unmap it
+	MappedWavFile(const MappedWavFile&) = delete;
+	MappedWavFile& operator=(const MappedWavFile&) = delete;
+
+private:
+	// Find the format and sample data in the mapped file
+	bool parse();
+	
+	// Read in the pages holding the samples and lock them in memory
+	void lockPages();
+
+	void *mapping_ = nullptr;					// Start of the mapped file
+	size_t mappingSize_ = 0;					// Length of the mapped file in bytes
+	const unsigned char *data_ = nullptr;		// Start of the sample data
+	unsigned int frames_ = 0;
+	unsigned int channels_ = 0;
+	unsigned int sampleRate_ = 0;
+	unsigned int bytesPerSample_ = 0;
+	Format format_ = FormatInt16;
+	bool isLocked_ = false;
+};
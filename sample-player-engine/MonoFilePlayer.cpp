@@ -0,0 +1,816 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+#include <libraries/AudioFile/AudioFile.h>
+#include <cstring>
+#include <cmath>
+#include "MonoFilePlayer.h"
+
+// Settings for streaming: the streaming buffer holds kStreamBufferSize samples
+// (about 1.5 seconds at 44.1kHz) and is filled kStreamChunkSize samples at a
+// time by a low-priority thread
+const unsigned int kStreamBufferSize = 65536;
+const unsigned int kStreamChunkSize = 4096;
+const int kStreamingPriority = 10;
+
+// Number of frames of a mapped file to convert to floats at a time
+const unsigned int kMappedBlockSize = 256;
+
+// Number of frames to convert to floats at a time when interpolating
+// samples that aren't stored as floats
+const unsigned int kInterpolationBufferSize = 1024;
+
+// Storage for the shared sinc interpolation tables
+std::vector<float> MonoFilePlayer::sincTables_;
+unsigned int MonoFilePlayer::sincTableStarts_[kNumSincTables];
+bool MonoFilePlayer::sincTablesReady_ = false;
+
+// Cutoff frequency of the sinc interpolation filter at normal speed, as a
+// fraction of the sample rate. Just below half so the short filter can
+// roll off in time.
+const float kSincCutoff = 0.45;
+
+// Fastest speed each sinc table is for, in quarters. The table for a speed
+// of s has its cutoff divided by s and kSincTaps * s taps.
+const int kSincTableQuarterSpeeds[MonoFilePlayer::kNumSincTables] = {4, 5, 6, 8, 10, 12, 16};
+
+// Constructor taking the path of a file to load
+MonoFilePlayer::MonoFilePlayer(const std::string& filename, bool loop, bool autostart)
+{
+	setup(filename, loop, autostart);	
+}
+
+// Load an audio file from the given filename. Returns true on success.
+bool MonoFilePlayer::setup(const std::string& filename, bool loop, bool autostart, float sampleRate,
+						   SampleBuffer::Format format)
+{
+	// Load the file, or share it if another player already has
+	return setup(SamplePool::global().load(filename, sampleRate, format), loop, autostart);
+}
+
+// Play a sample that has already been loaded
+bool MonoFilePlayer::setup(const SamplePool::Sample& sample, bool loop, bool autostart)
+{
+	clearLoopPoints();
+	loadPending_ = false;
+	readPointer_ = 0;
+	readFraction_ = 0;
+	isPlaying_ = autostart;
+	loop_ = loop;
+	mode_ = ModeMemory;
+	mappedFile_.close();
+	setRateRatio(1.0);
+	sample_ = sample;
+	
+	// Check for error
+	if(!sample_ || sample_->size() == 0) {
+		sample_.reset();
+		fileFrames_ = 0;
+		isPlaying_ = false;
+    	return false;
+	}
+	fileFrames_ = sample_->size();
+	interpolationBuffer_.resize(kInterpolationBufferSize);
+	
+	return true;
+}
+
+// Start loading an audio file in the background
+void MonoFilePlayer::setupAsync(const std::string& filename, bool loop, bool autostart,
+								float sampleRate, SampleBuffer::Format format)
+{
+	clearLoopPoints();
+	readPointer_ = 0;
+	readFraction_ = 0;
+	isPlaying_ = false;
+	loop_ = loop;
+	mode_ = ModeMemory;
+	mappedFile_.close();
+	setRateRatio(1.0);
+	sample_.reset();
+	fileFrames_ = 0;
+	
+	// Make space now for anything process() needs once the file is loaded
+	interpolationBuffer_.resize(kInterpolationBufferSize);
+	
+	loadRequest_ = SamplePool::global().loadAsync(filename, sampleRate, format);
+	loadPending_ = true;
+	autostartWhenLoaded_ = autostart;
+}
+
+// Start using the sample from setupAsync() if it has finished loading
+void MonoFilePlayer::checkAsyncLoad()
+{
+	if(!loadRequest_->isReady())
+		return;
+	loadPending_ = false;
+	
+	// Keep loadRequest_ until the next setup so it isn't freed here
+	sample_ = loadRequest_->get();
+	if(!sample_)
+		return;		// Couldn't load the file: stay silent
+	fileFrames_ = sample_->size();
+	isPlaying_ = autostartWhenLoaded_;
+}
+
+// Prepare to stream an audio file from the given filename. Returns true on success.
+bool MonoFilePlayer::setupStreaming(const std::string& filename, bool loop, bool autostart)
+{
+	clearLoopPoints();
+	loadPending_ = false;
+	isPlaying_ = false;
+	loop_ = loop;
+	mode_ = ModeStreaming;
+	sample_.reset();
+	mappedFile_.close();
+	setRateRatio(1.0);
+	
+	// Check the file exists and find out how long it is
+	int frames = AudioFileUtilities::getNumFrames(filename);
+	if(frames <= 0)
+		return false;
+	filename_ = filename;
+	fileFrames_ = frames;
+	
+	// Start with an empty buffer at the start of the file
+	streamBuffer_.assign(kStreamBufferSize, 0);
+	streamMask_ = kStreamBufferSize - 1;
+	filePosition_ = 0;
+	streamReadPointer_ = 0;
+	streamWritePointer_ = 0;
+	streamFinished_ = false;
+	restartRequest_ = restartDone_ = 0;
+	restartPending_ = false;
+	underruns_ = 0;
+	
+	// Create the streaming thread the first time. Each player needs a
+	// thread with its own name.
+	if(!streamingTask_) {
+		static unsigned int playerCount = 0;
+		std::string taskName = "mono-file-player-" + std::to_string(playerCount++);
+		streamingTask_ = Bela_createAuxiliaryTask(fillStreamingBuffer, kStreamingPriority,
+												  taskName.c_str(), this);
+		if(!streamingTask_)
+			return false;
+	}
+	
+	// Fill the buffer now so we can start playing straight away
+	fillStreamingBuffer();
+	
+	isPlaying_ = autostart;
+	return true;
+}
+
+// Map a WAV file from the given filename. Returns true on success.
+bool MonoFilePlayer::setupMapped(const std::string& filename, bool loop, bool autostart,
+								 float sampleRate)
+{
+	clearLoopPoints();
+	loadPending_ = false;
+	readPointer_ = 0;
+	readFraction_ = 0;
+	isPlaying_ = false;
+	loop_ = loop;
+	mode_ = ModeMapped;
+	sample_.reset();
+	
+	if(!mappedFile_.open(filename) || mappedFile_.getNumFrames() == 0) {
+		fileFrames_ = 0;
+		return false;
+	}
+	fileFrames_ = mappedFile_.getNumFrames();
+	
+	// Play a file with a different sample rate faster or slower, so that
+	// it comes out at the right pitch
+	if(sampleRate > 0)
+		setRateRatio(mappedFile_.getSampleRate() / sampleRate);
+	else
+		setRateRatio(1.0);
+	
+	// Like AudioFileUtilities::loadMono(), play the first channel
+	mappedFloats_ = mappedFile_.getFloatData(0);
+	mappedStride_ = mappedFile_.getNumChannels();
+	
+	// Make space to convert other formats, with nothing converted yet
+	mappedBlock_.resize(kMappedBlockSize);
+	mappedBlockStart_ = mappedBlockFrames_ = 0;
+	interpolationBuffer_.resize(kInterpolationBufferSize);
+	
+	isPlaying_ = autostart;
+	return true;
+}
+
+// Tell the buffer to start playing from the beginning
+void MonoFilePlayer::trigger()
+{
+	if(mode_ == ModeStreaming) {
+		// Ask the streaming thread to go back to the start of the file. We
+		// play nothing until it has, so we don't play old data in the buffer.
+		restartRequest_++;
+		restartPending_ = true;
+		isPlaying_ = true;
+		Bela_scheduleAuxiliaryTask(streamingTask_);
+		return;
+	}
+	
+	// Still loading in the background: play as soon as it's ready
+	if(loadPending_) {
+		autostartWhenLoaded_ = true;
+		return;
+	}
+	
+	if(size() == 0)
+		return;
+	readPointer_ = 0;
+	readFraction_ = 0;
+	isPlaying_ = true;	
+}
+
+// Return the next sample of the loaded audio file
+float MonoFilePlayer::process()
+{
+	if(loadPending_)
+		checkAsyncLoad();
+	if(!isPlaying_)	
+		return 0;
+	if(mode_ == ModeStreaming)
+		return processStreaming();
+	
+	// Anywhere other than exactly on a sample, we need to interpolate
+	if(speed_ != 1.0 || readFraction_ != 0) {
+		float out = readInterpolated();
+		advance();
+		return out;
+	}
+
+	// Read the next sample from the buffer
+	float out = readLooped(readPointer_);
+        
+	// Increment read pointer
+    readPointer_++;
+    
+    // If we reach the end, decide whether to loop or stop
+    if(readPointer_ >= (int)playEnd()) {
+     	if(loop_)
+     		readPointer_ = loopStart_;
+     	else {
+     		readPointer_ = 0;
+     		isPlaying_ = false;
+     	}
+    }
+    
+    return out;
+}
+
+// Fill a buffer with the next frames of the audio file
+void MonoFilePlayer::process(float *output, unsigned int frames)
+{
+	if(loadPending_)
+		checkAsyncLoad();
+	if(!isPlaying_) {
+		memset(output, 0, frames * sizeof(float));
+		return;
+	}
+	if(mode_ == ModeStreaming) {
+		processStreaming(output, frames);
+		return;
+	}
+	if(speed_ != 1.0 || readFraction_ != 0) {
+		processInterpolated(output, frames);
+		return;
+	}
+	
+	while(frames > 0) {
+		unsigned int count;
+		if(readPointer_ < (int)crossfadeStart()) {
+			// Copy as much as we can before reaching the crossfade or the
+			// end of the file
+			count = crossfadeStart() - readPointer_;
+			if(count > frames)
+				count = frames;
+			readFrames(readPointer_, count, output);
+		}
+		else {
+			// Mix the end of the loop with the frames before its start
+			count = playEnd() - readPointer_;
+			if(count > frames)
+				count = frames;
+			if(count > kInterpolationBufferSize)
+				count = kInterpolationBufferSize;
+			readCrossfade(readPointer_, count, output);
+		}
+		readPointer_ += count;
+		output += count;
+		frames -= count;
+		
+		// If we reach the end, decide whether to loop or stop
+		if(readPointer_ >= (int)playEnd()) {
+			if(loop_)
+				readPointer_ = loopStart_;
+			else {
+				readPointer_ = 0;
+				isPlaying_ = false;
+				memset(output, 0, frames * sizeof(float));
+				return;
+			}
+		}
+	}
+}
+
+// Set the playback speed
+void MonoFilePlayer::setSpeed(float speed)
+{
+	if(speed < 0)
+		speed = 0;
+	speed_ = speed * rateRatio_;
+	chooseSincTable();
+}
+
+// Choose the first sinc table that is for this speed or faster, so that
+// its cutoff is below half the sample rate of the sped-up sound
+void MonoFilePlayer::chooseSincTable()
+{
+	if(!sincTablesReady_)
+		return;
+	int table = 0;
+	while(table < kNumSincTables - 1 && 4.0 * speed_ > kSincTableQuarterSpeeds[table])
+		table++;
+	sincTable_ = &sincTables_[sincTableStarts_[table]];
+	sincTaps_ = kSincTaps * kSincTableQuarterSpeeds[table] / 4;
+}
+
+// Change the ratio between the file's sample rate and ours, keeping the
+// same playback speed
+void MonoFilePlayer::setRateRatio(float ratio)
+{
+	float speed = getSpeed();
+	rateRatio_ = ratio;
+	setSpeed(speed);
+}
+
+// Set the part of the file to loop, and the length of the crossfade
+void MonoFilePlayer::setLoopPoints(unsigned int startFrame, unsigned int endFrame,
+								   unsigned int crossfadeFrames)
+{
+	if(endFrame > size())
+		endFrame = size();
+	if(startFrame >= endFrame) {
+		clearLoopPoints();
+		return;
+	}
+	
+	// The crossfade can't be longer than the loop, or than the part of
+	// the file before the loop that it fades in from
+	if(crossfadeFrames > endFrame - startFrame)
+		crossfadeFrames = endFrame - startFrame;
+	if(crossfadeFrames > startFrame)
+		crossfadeFrames = startFrame;
+	
+	// Equal-power fade-in gains; the fade-out uses the same gains backwards
+	crossfadeGains_.resize(crossfadeFrames + 1);
+	for(unsigned int n = 0; n <= crossfadeFrames; n++)
+		crossfadeGains_[n] = sinf(0.5 * M_PI * n / (crossfadeFrames > 0 ? crossfadeFrames : 1));
+	
+	loopStart_ = startFrame;
+	loopEnd_ = endFrame;
+	crossfadeFrames_ = crossfadeFrames;
+	
+	// Don't get stuck past the end of the new loop
+	if(readPointer_ >= (int)loopEnd_)
+		readPointer_ = loopStart_;
+}
+
+// Go back to looping the whole file
+void MonoFilePlayer::clearLoopPoints()
+{
+	loopStart_ = loopEnd_ = 0;
+	crossfadeFrames_ = 0;
+}
+
+// Choose how to interpolate between samples
+void MonoFilePlayer::setInterpolation(Interpolation interpolation)
+{
+	if(interpolation == InterpolationSinc && !sincTable_) {
+		if(!sincTablesReady_)
+			makeSincTables();
+		chooseSincTable();
+	}
+	interpolation_ = interpolation;
+}
+
+// Fill the sinc interpolation tables. In each one, row p holds the
+// coefficients for a read position p / kSincPhases of the way from one
+// sample to the next.
+void MonoFilePlayer::makeSincTables()
+{
+	// Make space for all the tables at once
+	unsigned int size = 0;
+	for(int table = 0; table < kNumSincTables; table++) {
+		sincTableStarts_[table] = size;
+		size += (kSincPhases + 1) * kSincTaps * kSincTableQuarterSpeeds[table] / 4;
+	}
+	sincTables_.resize(size);
+	
+	for(int table = 0; table < kNumSincTables; table++) {
+		// Lower the cutoff and lengthen the filter by the speed
+		float speed = kSincTableQuarterSpeeds[table] / 4.0;
+		float cutoff = kSincCutoff / speed;
+		int taps = kSincTaps * kSincTableQuarterSpeeds[table] / 4;
+		
+		for(int phase = 0; phase <= kSincPhases; phase++) {
+			float *coefficients = &sincTables_[sincTableStarts_[table] + phase * taps];
+			float fraction = (float)phase / (float)kSincPhases;
+			float sum = 0;
+			for(int tap = 0; tap < taps; tap++) {
+				// Distance from the read position to this sample
+				float x = tap - (taps / 2 - 1) - fraction;
+				
+				// Low-pass sinc filter
+				float sinc = 2.0 * cutoff;
+				if(fabsf(x) > 1e-6)
+					sinc = sinf(2.0 * M_PI * cutoff * x) / (M_PI * x);
+				
+				// Blackman window, centred on the read position
+				float w = (x + taps / 2) / taps;
+				float window = 0;
+				if(w > 0 && w < 1)
+					window = 0.42 - 0.5 * cosf(2.0 * M_PI * w) + 0.08 * cosf(4.0 * M_PI * w);
+				
+				coefficients[tap] = sinc * window;
+				sum += sinc * window;
+			}
+			
+			// Make sure the gain at 0Hz is exactly 1
+			for(int tap = 0; tap < taps; tap++)
+				coefficients[tap] /= sum;
+		}
+	}
+	sincTablesReady_ = true;
+}
+
+// Copy frames from memory or the mapped file into output as floats
+void MonoFilePlayer::readFrames(unsigned int start, unsigned int count, float *output)
+{
+	if(mode_ == ModeMemory)
+		sample_->read(start, count, output);
+	else if(mappedFloats_ && mappedStride_ == 1)
+		memcpy(output, mappedFloats_ + start, count * sizeof(float));
+	else if(mappedFloats_) {
+		for(unsigned int n = 0; n < count; n++)
+			output[n] = mappedFloats_[(start + n) * mappedStride_];
+	}
+	else
+		mappedFile_.read(0, start, count, output);
+}
+
+// Return one frame, mixed with the start of the loop if it is in the crossfade
+float MonoFilePlayer::readLooped(unsigned int frame)
+{
+	float out = readFrame(frame);
+	unsigned int fadeStart = crossfadeStart();
+	if(frame >= fadeStart) {
+		unsigned int n = frame - fadeStart;
+		out = out * crossfadeGains_[crossfadeFrames_ - n]
+			  + readFrame(frame - (loopEnd_ - loopStart_)) * crossfadeGains_[n];
+	}
+	return out;
+}
+
+// Fill output with part of the crossfade
+void MonoFilePlayer::readCrossfade(unsigned int start, unsigned int count, float *output)
+{
+	// Read the end of the loop and the frames leading up to its start
+	float *fadeIn = interpolationBuffer_.data();
+	readFrames(start, count, output);
+	readFrames(start - (loopEnd_ - loopStart_), count, fadeIn);
+	
+	// Mix them, working out where in the crossfade this block is
+	unsigned int position = start - crossfadeStart();
+	for(unsigned int n = 0; n < count; n++) {
+		output[n] = output[n] * crossfadeGains_[crossfadeFrames_ - position - n]
+					+ fadeIn[n] * crossfadeGains_[position + n];
+	}
+}
+
+// Return one frame, wrapping around into the loop if looping
+float MonoFilePlayer::readSample(int frame)
+{
+	int end = playEnd();
+	if(frame >= end) {
+		if(!loop_)
+			return 0;
+		frame = loopStart_ + (frame - end) % (end - loopStart_);
+	}
+	else if(frame < 0) {
+		// Only a loop of the whole file has anything before its start
+		if(!loop_ || loopStart_ > 0)
+			return 0;
+		frame %= end;
+		if(frame < 0)
+			frame += end;
+	}
+	return readLooped(frame);
+}
+
+// Interpolate between samples. samples[0] is the sample just before the
+// read position; the samples around it are read as needed.
+float MonoFilePlayer::interpolate(const float *samples, float fraction)
+{
+	if(interpolation_ == InterpolationLinear)
+		return samples[0] + fraction * (samples[1] - samples[0]);
+	
+	if(interpolation_ == InterpolationCubic) {
+		// Catmull-Rom spline through the 4 nearest samples
+		float a = samples[-1], b = samples[0], c = samples[1], d = samples[2];
+		return b + 0.5 * fraction * (c - a + fraction * (2.0 * a - 5.0 * b + 4.0 * c - d
+				+ fraction * (3.0 * (b - c) + d - a)));
+	}
+	
+	// Sinc: interpolate between the two nearest rows of the table
+	float phase = fraction * kSincPhases;
+	int row = (int)phase;
+	float rowFraction = phase - row;
+	const float *coefficients = sincTable_ + row * sincTaps_;
+	const float *nextCoefficients = coefficients + sincTaps_;
+	const float *first = samples - (sincTaps_ / 2 - 1);
+	float out = 0, nextOut = 0;
+	for(int tap = 0; tap < sincTaps_; tap++) {
+		out += coefficients[tap] * first[tap];
+		nextOut += nextCoefficients[tap] * first[tap];
+	}
+	return out + rowFraction * (nextOut - out);
+}
+
+// Return the interpolated sample at the read position, one sample at a time
+float MonoFilePlayer::readInterpolated()
+{
+	// Gather the samples around the read position, wrapping or padding
+	// with zeros at the ends of the file
+	float samples[kMaxSincTaps];
+	const int first = sincTaps_ / 2 - 1;
+	for(int tap = 0; tap < sincTaps_; tap++)
+		samples[tap] = readSample(readPointer_ - first + tap);
+	return interpolate(&samples[first], readFraction_);
+}
+
+// Move the read position on by the playback speed
+void MonoFilePlayer::advance()
+{
+	readFraction_ += speed_;
+	int whole = (int)readFraction_;
+	readPointer_ += whole;
+	readFraction_ -= whole;
+	checkEndOfFile();
+}
+
+// Loop or stop if the read position has gone past the end of the file
+void MonoFilePlayer::checkEndOfFile()
+{
+	int end = playEnd();
+	if(readPointer_ >= end) {
+		if(loop_)
+			readPointer_ = loopStart_ + (readPointer_ - end) % (end - loopStart_);
+		else {
+			readPointer_ = 0;
+			readFraction_ = 0;
+			isPlaying_ = false;
+		}
+	}
+}
+
+// Fill a buffer when playing at a different speed
+void MonoFilePlayer::processInterpolated(float *output, unsigned int frames)
+{
+	// Float samples we can read directly. Others are converted into
+	// interpolationBuffer_ a run at a time.
+	const float *samples = nullptr;
+	if(mode_ == ModeMemory)
+		samples = sample_->data();
+	else if(mappedFloats_ && mappedStride_ == 1)
+		samples = mappedFloats_;
+	
+	// Every kind of interpolation only needs samples this far either side
+	const int before = sincTaps_ / 2 - 1;
+	const int after = sincTaps_ / 2;
+	
+	unsigned int n = 0;
+	while(n < frames && isPlaying_) {
+		// Work out how many frames we can make before getting near the end
+		// of the file or the loop crossfade, leaving a spare sample for
+		// rounding errors
+		unsigned int count = 0;
+		if(readPointer_ >= before) {
+			float distance = (int)crossfadeStart() - after - 2 - readPointer_ - readFraction_;
+			if(distance >= 0) {
+				if(speed_ * (frames - n) <= distance)
+					count = frames - n;
+				else
+					count = (unsigned int)(distance / speed_) + 1;
+			}
+		}
+		
+		if(count == 0) {
+			// Near the ends of the file: go one sample at a time
+			output[n++] = readInterpolated();
+			advance();
+			continue;
+		}
+		
+		// In the middle of the file: read straight from the samples, or
+		// convert all the samples this run needs in one go
+		const float *input = samples;
+		int readPointer = readPointer_;
+		if(!samples) {
+			float room = kInterpolationBufferSize - before - after - 2 - readFraction_;
+			if(speed_ * (count - 1) > room)
+				count = (unsigned int)(room / speed_) + 1;
+			unsigned int length = (unsigned int)(readFraction_ + speed_ * (count - 1)) + before + after + 2;
+			if(length > size() - (readPointer_ - before))
+				length = size() - (readPointer_ - before);
+			readFrames(readPointer_ - before, length, interpolationBuffer_.data());
+			input = interpolationBuffer_.data();
+			readPointer = before;
+		}
+		int startPointer = readPointer;
+		float readFraction = readFraction_;
+		for(unsigned int end = n + count; n < end; n++) {
+			output[n] = interpolate(input + readPointer, readFraction);
+			readFraction += speed_;
+			int whole = (int)readFraction;
+			readPointer += whole;
+			readFraction -= whole;
+		}
+		readPointer_ += readPointer - startPointer;
+		readFraction_ = readFraction;
+		checkEndOfFile();
+	}
+	
+	// Silence after the end of the file
+	for(; n < frames; n++)
+		output[n] = 0;
+}
+
+// Return one sample of the mapped file
+float MonoFilePlayer::readMapped(unsigned int frame)
+{
+	// Float samples can be read where they are
+	if(mappedFloats_)
+		return mappedFloats_[frame * mappedStride_];
+	
+	// Otherwise convert the block of samples that this frame is in
+	if(frame < mappedBlockStart_ || frame >= mappedBlockStart_ + mappedBlockFrames_) {
+		mappedBlockStart_ = frame;
+		mappedBlockFrames_ = kMappedBlockSize;
+		if(mappedBlockFrames_ > fileFrames_ - frame)
+			mappedBlockFrames_ = fileFrames_ - frame;
+		mappedFile_.read(0, mappedBlockStart_, mappedBlockFrames_, mappedBlock_.data());
+	}
+	return mappedBlock_[frame - mappedBlockStart_];
+}
+
+// Check whether the streaming thread has gone back to the start of the file
+bool MonoFilePlayer::checkStreamingRestart()
+{
+	if(!restartPending_)
+		return true;
+	
+	// Wait for the streaming thread to go back to the start, then
+	// skip anything it had already read before that
+	if(restartDone_.load(std::memory_order_acquire) != restartRequest_.load(std::memory_order_relaxed))
+		return false;
+	streamReadPointer_.store(restartPointer_.load(std::memory_order_relaxed), std::memory_order_release);
+	restartPending_ = false;
+	
+	// That emptied the buffer, so it needs filling again
+	Bela_scheduleAuxiliaryTask(streamingTask_);
+	return true;
+}
+
+// Return the next sample from the streaming buffer
+float MonoFilePlayer::processStreaming()
+{
+	if(!checkStreamingRestart())
+		return 0;
+	
+	// Check whether the file has finished before looking for samples,
+	// so the last samples it wrote are always seen
+	bool finished = streamFinished_.load(std::memory_order_acquire);
+	unsigned int readPointer = streamReadPointer_.load(std::memory_order_relaxed);
+	if(readPointer == streamWritePointer_.load(std::memory_order_acquire)) {
+		if(finished)
+			isPlaying_ = false;		// Played the whole file
+		else {
+			// The streaming thread didn't keep up. Make sure it is awake,
+			// without scheduling it on every sample.
+			if((underruns_++ & (kStreamChunkSize - 1)) == 0)
+				Bela_scheduleAuxiliaryTask(streamingTask_);
+		}
+		return 0;
+	}
+	
+	float out = streamBuffer_[readPointer & streamMask_];
+	streamReadPointer_.store(readPointer + 1, std::memory_order_release);
+	
+	// Each time a chunk of space is free, wake up the streaming thread
+	if(((readPointer + 1) & (kStreamChunkSize - 1)) == 0)
+		Bela_scheduleAuxiliaryTask(streamingTask_);
+	
+	return out;
+}
+
+// Fill a buffer from the streaming buffer
+void MonoFilePlayer::processStreaming(float *output, unsigned int frames)
+{
+	if(!checkStreamingRestart()) {
+		memset(output, 0, frames * sizeof(float));
+		return;
+	}
+	
+	while(frames > 0) {
+		bool finished = streamFinished_.load(std::memory_order_acquire);
+		unsigned int readPointer = streamReadPointer_.load(std::memory_order_relaxed);
+		unsigned int available = streamWritePointer_.load(std::memory_order_acquire) - readPointer;
+		if(available == 0) {
+			if(finished)
+				isPlaying_ = false;		// Played the whole file
+			else {
+				// The streaming thread didn't keep up: wake it up and
+				// count everything we couldn't play
+				Bela_scheduleAuxiliaryTask(streamingTask_);
+				underruns_ += frames;
+			}
+			memset(output, 0, frames * sizeof(float));
+			return;
+		}
+		
+		// Copy as much as we can before the end of the circular buffer
+		unsigned int start = readPointer & streamMask_;
+		unsigned int count = streamBuffer_.size() - start;
+		if(count > available)
+			count = available;
+		if(count > frames)
+			count = frames;
+		memcpy(output, &streamBuffer_[start], count * sizeof(float));
+		streamReadPointer_.store(readPointer + count, std::memory_order_release);
+		output += count;
+		frames -= count;
+		
+		// Each time a chunk of space is free, wake up the streaming thread
+		if((readPointer & ~(kStreamChunkSize - 1)) != ((readPointer + count) & ~(kStreamChunkSize - 1)))
+			Bela_scheduleAuxiliaryTask(streamingTask_);
+	}
+}
+
+// Read from the file into the streaming buffer until it is full
+void MonoFilePlayer::fillStreamingBuffer()
+{
+	// Go back to the start of the file if trigger() asked for it
+	unsigned int request = restartRequest_.load(std::memory_order_acquire);
+	if(request != restartDone_.load(std::memory_order_relaxed)) {
+		filePosition_ = 0;
+		streamFinished_.store(false, std::memory_order_relaxed);
+		restartPointer_.store(streamWritePointer_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		restartDone_.store(request, std::memory_order_release);
+	}
+	
+	while(!streamFinished_.load(std::memory_order_relaxed)) {
+		unsigned int writePointer = streamWritePointer_.load(std::memory_order_relaxed);
+		unsigned int readPointer = streamReadPointer_.load(std::memory_order_acquire);
+		unsigned int space = streamBuffer_.size() - (writePointer - readPointer);
+		
+		// Read a chunk at a time, without going past the end of the file
+		// or the end of the circular buffer
+		unsigned int count = kStreamChunkSize;
+		if(count > space)
+			break;	// Full for now
+		if(count > fileFrames_ - filePosition_)
+			count = fileFrames_ - filePosition_;
+		if(count > streamBuffer_.size() - (writePointer & streamMask_))
+			count = streamBuffer_.size() - (writePointer & streamMask_);
+		
+		if(AudioFileUtilities::getSamples(filename_, &streamBuffer_[writePointer & streamMask_],
+										  0, filePosition_, filePosition_ + count) != 0) {
+			// Couldn't read the file: stop here rather than play garbage
+			streamFinished_.store(true, std::memory_order_release);
+			break;
+		}
+		streamWritePointer_.store(writePointer + count, std::memory_order_release);
+		
+		// At the end of the file, either go back to the start or finish
+		filePosition_ += count;
+		if(filePosition_ >= fileFrames_) {
+			filePosition_ = 0;
+			if(!loop_)
+				streamFinished_.store(true, std::memory_order_release);
+		}
+	}
+}
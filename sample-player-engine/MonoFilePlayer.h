@@ -0,0 +1,281 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// This is a simple class encapsulating the playback of a sound
+// loaded from an audio file. It offers basic controls to loop, start
+// and stop the playback. It assumes a mono audio file.
+//
+// Files can either be loaded into memory all at once with setup(), or
+// streamed from disk with setupStreaming(). When streaming, a low-priority
+// thread reads the file a chunk at a time into a fixed-size circular
+// buffer and process() only ever reads from that buffer, so memory use
+// doesn't depend on the length of the file.
+//
+// Uncompressed WAV files can also be mapped into memory with setupMapped(),
+// which starts almost instantly and doesn't make a copy of the file.
+//
+// Files in memory or mapped can be played at any speed. The samples between
+// the ones in the file are found by linear, cubic or windowed sinc
+// interpolation. They can also loop just part of the file, with a
+// crossfade where the end of the loop joins back to the start.
+
+#pragma once
+
+#include <Bela.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include "MappedWavFile.h"
+#include "SamplePool.h"
+
+class MonoFilePlayer {
+private:
+	// Where the samples come from
+	enum Mode {
+		ModeMemory = 0,		// Loaded into memory and shared through the SamplePool
+		ModeStreaming,		// Streamed from disk into streamBuffer_
+		ModeMapped			// Read in place from a memory-mapped WAV file
+	};
+
+public:
+	// Ways of finding the sound between two samples when playing at a
+	// different speed
+	enum Interpolation {
+		InterpolationLinear = 0,	// Straight line between 2 samples
+		InterpolationCubic,			// Smooth curve through 4 samples
+		InterpolationSinc			// Windowed sinc filter over kSincTaps samples or more
+	};
+	
+	// Number of samples used by sinc interpolation at normal speed or
+	// slower, and the number of fractional positions in its lookup tables
+	static const int kSincTaps = 16;
+	static const int kSincPhases = 256;
+	
+	// Faster than normal speed, the sinc filter's cutoff has to be lowered
+	// by the speed so that it doesn't alias, and it needs more samples to
+	// stay as steep. There is a table for each of a few speeds up to
+	// kMaxSincSpeed, and each speed uses the table for the next one up.
+	// Faster than kMaxSincSpeed, the sound may alias.
+	static const int kNumSincTables = 7;
+	static const int kMaxSincSpeed = 4;
+	static const int kMaxSincTaps = kSincTaps * kMaxSincSpeed;
+	
+	// Constructors: the one with arguments automatically calls setup()
+	MonoFilePlayer() {}
+	MonoFilePlayer(const std::string& filename, bool loop = true, bool autostart = true);
+	
+	// Load an audio file from the given filename. Returns true on success.
+	// Players of the same file share one copy of it through the SamplePool.
+	// If a sample rate is given, the file is converted to that rate.
+	// SampleBuffer::FormatInt16 keeps the file in half the memory.
+	bool setup(const std::string& filename, bool loop = true, bool autostart = true,
+			   float sampleRate = 0, SampleBuffer::Format format = SampleBuffer::FormatFloat);
+	
+	// Play a sample that has already been loaded
+	bool setup(const SamplePool::Sample& sample, bool loop = true, bool autostart = true);
+	
+	// Start loading an audio file in the background and return straight
+	// away. The player is silent until the file has loaded, then starts
+	// playing if autostart is set. Use isLoaded() to check on it.
+	void setupAsync(const std::string& filename, bool loop = true, bool autostart = true,
+					float sampleRate = 0, SampleBuffer::Format format = SampleBuffer::FormatFloat);
+	
+	// Return whether there is a sound ready to play
+	bool isLoaded() { return fileFrames_ > 0; }
+	
+	// Prepare to stream an audio file from disk instead of loading it.
+	// Returns true on success.
+	bool setupStreaming(const std::string& filename, bool loop = true, bool autostart = true);
+	
+	// Map an uncompressed WAV file into memory and play it from there.
+	// Returns true on success, or false if the file isn't a WAV file
+	// that can be mapped, in which case setup() can still load it.
+	// The samples can't be converted in place, so if a sample rate is given
+	// and the file has a different one, the speed is adjusted to keep the
+	// pitch right.
+	bool setupMapped(const std::string& filename, bool loop = true, bool autostart = true,
+					 float sampleRate = 0);
+	
+	// Start or stop the playback
+	void trigger();
+	void stop() { isPlaying_ = false; }
+	
+	// Set the playback speed: 1 is normal, 2 is an octave higher, 0.5 an
+	// octave lower. Negative speeds are not supported. The speed doesn't
+	// change when streaming, which only plays at the normal speed.
+	void setSpeed(float speed);
+	float getSpeed() { return speed_ / rateRatio_; }
+	
+	// Choose how to interpolate between samples. Choosing sinc interpolation
+	// for the first time fills its lookup tables, so do it in setup().
+	void setInterpolation(Interpolation interpolation);
+	
+	// Loop from startFrame up to (not including) endFrame instead of the
+	// whole file. The last crossfadeFrames before endFrame are faded into
+	// the frames just before startFrame with an equal-power crossfade, so
+	// the join doesn't click. Playback starts from the beginning of the
+	// file and stays in the loop once it gets there. Call this from setup(),
+	// after the file has loaded; it doesn't apply when streaming.
+	void setLoopPoints(unsigned int startFrame, unsigned int endFrame,
+					   unsigned int crossfadeFrames = 0);
+	
+	// Go back to looping the whole file
+	void clearLoopPoints();
+
+	// Return the length of the file in samples
+	unsigned int size() { return fileFrames_; }
+	
+	// Return the next sample of the loaded audio file
+	float process();
+	
+	// Fill a buffer with the next frames of the audio file. This does the
+	// same as calling process() for each frame, but copies the samples a
+	// run at a time instead of checking for the end of the file every time.
+	void process(float *output, unsigned int frames);
+	
+	// Return how many samples were missed because the streaming thread
+	// couldn't keep up (always 0 when not streaming)
+	unsigned int underruns() { return underruns_; }
+	
+	// Destructor
+	~MonoFilePlayer() {}
+	
+private:
+	// Start using the sample from setupAsync() if it has finished loading
+	void checkAsyncLoad();
+	
+	// Return the next sample when streaming
+	float processStreaming();
+	
+	// Fill a buffer from the streaming buffer
+	void processStreaming(float *output, unsigned int frames);
+	
+	// Check whether the streaming thread has finished going back to the
+	// start of the file. Returns false if we are still waiting for it.
+	bool checkStreamingRestart();
+	
+	// Return one sample of the mapped file
+	float readMapped(unsigned int frame);
+	
+	// Copy frames from memory or the mapped file into output as floats
+	void readFrames(unsigned int start, unsigned int count, float *output);
+	
+	// Return one frame from memory or the mapped file
+	float readFrame(unsigned int frame) {
+		return (mode_ == ModeMemory) ? sample_->sample(frame) : readMapped(frame);
+	}
+	
+	// Return the frame after which playback loops or stops
+	unsigned int playEnd() { return (loop_ && loopEnd_ > 0) ? loopEnd_ : size(); }
+	
+	// Return the first frame of the loop crossfade, or playEnd() if there isn't one
+	unsigned int crossfadeStart() { return playEnd() - (loop_ ? crossfadeFrames_ : 0); }
+	
+	// Return one frame, mixed with the start of the loop if it is in the crossfade
+	float readLooped(unsigned int frame);
+	
+	// Fill output with count frames of the crossfade, starting at frame start
+	void readCrossfade(unsigned int start, unsigned int count, float *output);
+	
+	// Return one frame, wrapping around to the loop start if looping and
+	// returning 0 outside the file otherwise
+	float readSample(int frame);
+	
+	// Interpolate between samples, where samples points to the sample just
+	// before the read position and fraction is how far past it we are
+	float interpolate(const float *samples, float fraction);
+	
+	// Return the interpolated sample at the read position, reading each
+	// sample with readSample()
+	float readInterpolated();
+	
+	// Move the read position on by the playback speed, looping or stopping
+	// at the end of the file
+	void advance();
+	
+	// Loop or stop if the read position has gone past the end of the file
+	// or the loop
+	void checkEndOfFile();
+	
+	// Set the sample rate of the file divided by the rate it is played at
+	void setRateRatio(float ratio);
+	
+	// Fill a buffer when playing at a different speed
+	void processInterpolated(float *output, unsigned int frames);
+	
+	// Fill the sinc interpolation lookup tables, shared by all players
+	static void makeSincTables();
+	
+	// Choose the sinc table for the current speed
+	void chooseSincTable();
+	
+	// Sinc interpolation tables, one after the other. Each has one row of
+	// coefficients for each fractional position, plus one more row so we
+	// can interpolate between rows. sincTableStarts_ says where each begins.
+	static std::vector<float> sincTables_;
+	static unsigned int sincTableStarts_[kNumSincTables];
+	static bool sincTablesReady_;
+	
+	// Read from the file into the streaming buffer until it is full.
+	// This runs in the streaming thread, apart from when first filling
+	// the buffer in setupStreaming().
+	void fillStreamingBuffer();
+	static void fillStreamingBuffer(void *player) { ((MonoFilePlayer *)player)->fillStreamingBuffer(); }
+
+	SamplePool::Sample sample_;					// Sound loaded into memory, shared with other players
+	int readPointer_ = 0;						// Position of the last frame we played 
+	float readFraction_ = 0;					// Position between readPointer_ and the next frame
+	float speed_ = 1.0;							// Playback speed, including rateRatio_
+	float rateRatio_ = 1.0;						// Sample rate of a mapped file / the rate we play at
+	const float *sincTable_ = nullptr;			// Sinc table for the current speed
+	int sincTaps_ = kSincTaps;					// Number of coefficients in each row of sincTable_
+	std::vector<float> interpolationBuffer_;	// Samples converted to floats for interpolating
+	SamplePool::RequestHandle loadRequest_;		// Sample being loaded by setupAsync()
+	bool loadPending_ = false;					// Whether we are still waiting for loadRequest_
+	bool autostartWhenLoaded_ = false;			// Whether to play as soon as loadRequest_ is ready
+	Interpolation interpolation_ = InterpolationCubic;	// How to find the samples in between
+	unsigned int loopStart_ = 0;				// First frame of the loop
+	unsigned int loopEnd_ = 0;					// Frame after the end of the loop, or 0 for the end of the file
+	unsigned int crossfadeFrames_ = 0;			// Length of the crossfade at the end of the loop
+	std::vector<float> crossfadeGains_;			// Fade-in gain for each frame of the crossfade
+	bool loop_ = false;							// Whether the playback loops at the end
+	bool isPlaying_ = false;					// Whether we are currently playing
+	Mode mode_ = ModeMemory;					// Where the samples come from
+	unsigned int fileFrames_ = 0;				// Length of the file
+	
+	// Variables used when streaming. The buffer pointers count up forever
+	// and are wrapped with streamMask_ when reading the buffer, so that
+	// their difference is always how many samples are waiting.
+	std::string filename_;						// File we are streaming from
+	unsigned int filePosition_ = 0;				// Next frame to read from the file (streaming thread only)
+	std::vector<float> streamBuffer_;			// Circular buffer filled by the streaming thread
+	unsigned int streamMask_ = 0;				// Size of streamBuffer_ minus 1 (size is a power of 2)
+	std::atomic<unsigned int> streamReadPointer_{0};	// Only changed by process()
+	std::atomic<unsigned int> streamWritePointer_{0};	// Only changed by the streaming thread
+	std::atomic<bool> streamFinished_{false};	// Set when the file has been read to the end (no loop)
+	std::atomic<unsigned int> restartRequest_{0};	// Increased by trigger() to go back to the start
+	std::atomic<unsigned int> restartDone_{0};	// Set to restartRequest_ by the streaming thread when done
+	std::atomic<unsigned int> restartPointer_{0};	// Write pointer at the point the file started again
+	bool restartPending_ = false;				// Waiting for the streaming thread to restart
+	std::atomic<unsigned int> underruns_{0};	// Samples missed because the buffer was empty
+	AuxiliaryTask streamingTask_ = 0;			// Thread that reads the file
+	
+	// Variables used when the file is mapped. Float files are read in place;
+	// other formats are converted a block at a time into mappedBlock_.
+	MappedWavFile mappedFile_;
+	const float *mappedFloats_ = nullptr;		// Samples to read in place, if they are floats
+	unsigned int mappedStride_ = 1;				// Step between frames in mappedFloats_
+	std::vector<float> mappedBlock_;			// Converted samples
+	unsigned int mappedBlockStart_ = 0;			// First frame held in mappedBlock_
+	unsigned int mappedBlockFrames_ = 0;		// Number of frames held in mappedBlock_
+};
+
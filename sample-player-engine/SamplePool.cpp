@@ -0,0 +1,396 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// SamplePool.cpp: share loaded audio files between players
+
+#include <libraries/AudioFile/AudioFile.h>
+#include <sndfile.h>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "SamplePool.h"
+
+constexpr float SampleBuffer::kInt16Scale;
+
+// Keep the samples in the given format
+SampleBuffer::SampleBuffer(std::vector<float>&& samples, float sampleRate, Format format)
+: size_(samples.size()), sampleRate_(sampleRate), format_(format)
+{
+	if(format_ == FormatFloat) {
+		samples_ = std::move(samples);
+		return;
+	}
+	
+	// Round each sample to 16 bits, keeping inside the range
+	compactSamples_.resize(size_);
+	for(unsigned int n = 0; n < size_; n++) {
+		long value = lrintf(samples[n] * 32768.0f);
+		if(value > 32767)
+			value = 32767;
+		else if(value < -32768)
+			value = -32768;
+		compactSamples_[n] = value;
+	}
+}
+
+// Keep samples that are already 16-bit
+SampleBuffer::SampleBuffer(std::vector<int16_t>&& samples, float sampleRate)
+: compactSamples_(std::move(samples)), sampleRate_(sampleRate), format_(FormatInt16)
+{
+	size_ = compactSamples_.size();
+}
+
+// Return the samples as stored
+const void *SampleBuffer::rawData() const
+{
+	if(format_ == FormatFloat)
+		return samples_.data();
+	return compactSamples_.data();
+}
+
+// Return the size of the samples in bytes
+unsigned int SampleBuffer::rawSize() const
+{
+	if(format_ == FormatFloat)
+		return size_ * sizeof(float);
+	return size_ * sizeof(int16_t);
+}
+
+// Copy samples into output as floats
+void SampleBuffer::read(unsigned int start, unsigned int count, float *output) const
+{
+	if(format_ == FormatFloat) {
+		memcpy(output, &samples_[start], count * sizeof(float));
+		return;
+	}
+	
+	// A simple loop like this is vectorised by the compiler, converting
+	// several samples per instruction
+	const int16_t *input = &compactSamples_[start];
+	for(unsigned int n = 0; n < count; n++)
+		output[n] = input[n] * kInt16Scale;
+}
+
+// Start of each cache file. The version changes if the layout ever does.
+struct CacheHeader {
+	char magic[4];			// Always kCacheMagic
+	uint32_t version;		// kCacheVersion
+	uint32_t format;		// SampleBuffer::Format of the samples
+	uint32_t sampleRate;	// Sample rate of the samples
+	uint32_t frames;		// Number of samples after the header
+	uint32_t reserved;
+	int64_t sourceSize;		// Size of the audio file the samples came from
+	int64_t sourceModified;	// Time the audio file was last changed
+};
+static const char kCacheMagic[4] = {'B', 'S', 'M', 'P'};
+static const uint32_t kCacheVersion = 1;
+
+// Fewest worker threads to use for background loading
+static const unsigned int kMinLoadThreads = 2;
+
+// Return the pool shared by the whole program
+SamplePool& SamplePool::global()
+{
+	static SamplePool pool;
+	return pool;
+}
+
+// Convert a sound to a different sample rate with linear interpolation.
+// This only happens once when loading, not while playing.
+static std::vector<float> changeSampleRate(const std::vector<float>& input, float ratio)
+{
+	std::vector<float> output(input.size() / ratio);
+	for(unsigned int n = 0; n < output.size(); n++) {
+		float position = n * ratio;
+		unsigned int indexBelow = position;
+		unsigned int indexAbove = indexBelow + 1;
+		if(indexAbove >= input.size())
+			indexAbove = input.size() - 1;
+		float fractionAbove = position - indexBelow;
+		output[n] = (1.0 - fractionAbove) * input[indexBelow] + fractionAbove * input[indexAbove];
+	}
+	return output;
+}
+
+// Return a shared sample, loading it if needed
+SamplePool::Sample SamplePool::load(const std::string& filename, float sampleRate,
+									SampleBuffer::Format format)
+{
+	// Different names for the same file should find the same sample
+	std::string path = filename;
+	char fullPath[PATH_MAX];
+	if(realpath(filename.c_str(), fullPath))
+		path = fullPath;
+	
+	unsigned int rate = (sampleRate > 0) ? lroundf(sampleRate) : 0;
+	Key key(path, rate, format);
+	
+	std::unique_lock<std::mutex> lock(mutex_);
+	std::string cacheDirectory = cacheDirectory_;
+	
+	// Share the sample if it's already loaded and someone is still using it
+	auto it = samples_.find(key);
+	if(it != samples_.end()) {
+		Sample sample = it->second.lock();
+		if(sample)
+			return sample;
+	}
+	
+	// If another thread is already loading it, wait for that instead
+	auto loading = loading_.find(key);
+	if(loading != loading_.end()) {
+		std::shared_future<Sample> result = loading->second;
+		lock.unlock();
+		return result.get();
+	}
+	std::promise<Sample> promise;
+	loading_[key] = promise.get_future().share();
+	
+	// Load it without holding the lock, so other files can load at the same time.
+	// Read it from the cache, or decode it and save it in the cache.
+	lock.unlock();
+	Sample sample;
+	if(!cacheDirectory.empty())
+		sample = readCache(cacheDirectory, path, rate, format);
+	if(!sample) {
+		sample = decode(path, rate, format);
+		if(sample && !cacheDirectory.empty())
+			writeCache(cacheDirectory, path, rate, sample);
+	}
+	lock.lock();
+	
+	loading_.erase(key);
+	if(sample)
+		samples_[key] = sample;
+	
+	// Forget any samples that are no longer used by anyone
+	for(it = samples_.begin(); it != samples_.end(); ) {
+		if(it->second.expired())
+			it = samples_.erase(it);
+		else
+			++it;
+	}
+	lock.unlock();
+	
+	promise.set_value(sample);
+	return sample;
+}
+
+// Start loading an audio file in the background
+SamplePool::RequestHandle SamplePool::loadAsync(const std::string& filename, float sampleRate,
+												SampleBuffer::Format format)
+{
+	RequestHandle request = std::make_shared<Request>();
+	
+	std::lock_guard<std::mutex> lock(jobsMutex_);
+	
+	// Start the worker threads the first time. Even on a single core it
+	// helps to have more than one, so one file can be decoded while
+	// another is waiting for the disk.
+	if(workers_.empty()) {
+		unsigned int numWorkers = std::thread::hardware_concurrency();
+		if(numWorkers < kMinLoadThreads)
+			numWorkers = kMinLoadThreads;
+		for(unsigned int i = 0; i < numWorkers; i++)
+			workers_.push_back(std::thread(&SamplePool::workerLoop, this));
+	}
+	
+	jobs_.push_back([this, request, filename, sampleRate, format]() {
+		request->sample_ = load(filename, sampleRate, format);
+		request->ready_.store(true, std::memory_order_release);
+		request->promise_.set_value();
+	});
+	jobsChanged_.notify_one();
+	
+	return request;
+}
+
+// Run background loads until the pool is destroyed
+void SamplePool::workerLoop()
+{
+	while(true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex_);
+			jobsChanged_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+			if(jobs_.empty())
+				return;		// Stopping, with nothing left to do
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+		}
+		job();
+	}
+}
+
+// Destructor: finish any loads in progress and stop the worker threads
+SamplePool::~SamplePool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex_);
+		stopping_ = true;
+	}
+	jobsChanged_.notify_all();
+	for(auto& worker : workers_)
+		worker.join();
+}
+
+// Decode an audio file
+SamplePool::Sample SamplePool::decode(const std::string& filename, unsigned int sampleRate,
+									  SampleBuffer::Format format)
+{
+	// Find the sample rate of the file
+	SF_INFO info;
+	info.format = 0;
+	SNDFILE *file = sf_open(filename.c_str(), SFM_READ, &info);
+	if(!file)
+		return Sample();
+	sf_close(file);
+	if(sampleRate == 0)
+		sampleRate = info.samplerate;
+	
+	std::vector<float> samples = AudioFileUtilities::loadMono(filename);
+	if(samples.empty())
+		return Sample();
+	if(sampleRate != (unsigned int)info.samplerate)
+		samples = changeSampleRate(samples, (float)info.samplerate / (float)sampleRate);
+	
+	return std::make_shared<const SampleBuffer>(std::move(samples), sampleRate, format);
+}
+
+// Keep cache files in the given directory
+bool SamplePool::setCacheDirectory(const std::string& directory)
+{
+	// Make the directory and any missing directories above it
+	for(size_t end = 1; !directory.empty(); end++) {
+		end = directory.find('/', end);
+		std::string partial = directory.substr(0, end);
+		if(mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST)
+			return false;
+		if(end == std::string::npos)
+			break;
+	}
+	
+	std::lock_guard<std::mutex> lock(mutex_);
+	cacheDirectory_ = directory;
+	return true;
+}
+
+// Return the name of the cache file for an audio file. The whole path of
+// the audio file goes into the name, so files with the same name in
+// different folders don't share a cache file.
+std::string SamplePool::cacheFilename(const std::string& directory, const std::string& filename,
+									  unsigned int sampleRate, SampleBuffer::Format format)
+{
+	std::string name = filename;
+	for(char& c : name) {
+		if(c == '/')
+			c = '_';
+	}
+	name = directory + "/" + name;
+	if(sampleRate > 0)
+		name += "." + std::to_string(sampleRate);
+	name += (format == SampleBuffer::FormatInt16) ? ".s16.cache" : ".f32.cache";
+	return name;
+}
+
+// Load the samples from a cache file
+SamplePool::Sample SamplePool::readCache(const std::string& directory, const std::string& filename,
+										 unsigned int sampleRate, SampleBuffer::Format format)
+{
+	// The cache is only good if the audio file is the same as when it was made
+	struct stat source;
+	if(stat(filename.c_str(), &source) != 0)
+		return Sample();
+	
+	int fd = open(cacheFilename(directory, filename, sampleRate, format).c_str(), O_RDONLY);
+	if(fd < 0)
+		return Sample();
+	
+	Sample sample;
+	CacheHeader header;
+	struct stat cache;
+	unsigned int sampleSize = (format == SampleBuffer::FormatInt16) ? sizeof(int16_t) : sizeof(float);
+	if(read(fd, &header, sizeof(header)) == sizeof(header)
+	   && memcmp(header.magic, kCacheMagic, sizeof(header.magic)) == 0
+	   && header.version == kCacheVersion
+	   && header.format == (uint32_t)format
+	   && header.sourceSize == (int64_t)source.st_size
+	   && header.sourceModified == (int64_t)source.st_mtime
+	   && header.frames > 0
+	   && fstat(fd, &cache) == 0
+	   && cache.st_size == (off_t)(sizeof(header) + (off_t)header.frames * sampleSize)) {
+		// Read all the samples at once
+		ssize_t bytes = (ssize_t)header.frames * sampleSize;
+		if(format == SampleBuffer::FormatInt16) {
+			std::vector<int16_t> samples(header.frames);
+			if(read(fd, samples.data(), bytes) == bytes)
+				sample = std::make_shared<const SampleBuffer>(std::move(samples), header.sampleRate);
+		}
+		else {
+			std::vector<float> samples(header.frames);
+			if(read(fd, samples.data(), bytes) == bytes)
+				sample = std::make_shared<const SampleBuffer>(std::move(samples), header.sampleRate);
+		}
+	}
+	close(fd);
+	return sample;
+}
+
+// Save samples in a cache file
+void SamplePool::writeCache(const std::string& directory, const std::string& filename,
+							unsigned int sampleRate, const Sample& sample)
+{
+	struct stat source;
+	if(stat(filename.c_str(), &source) != 0)
+		return;
+	
+	CacheHeader header = {};
+	memcpy(header.magic, kCacheMagic, sizeof(header.magic));
+	header.version = kCacheVersion;
+	header.format = sample->getFormat();
+	header.sampleRate = sample->getSampleRate();
+	header.frames = sample->size();
+	header.sourceSize = source.st_size;
+	header.sourceModified = source.st_mtime;
+	
+	// Write to a temporary file and then rename it, so another program
+	// starting at the same time never sees half a cache file. If the
+	// directory can't be written to, we just go without a cache.
+	std::string name = cacheFilename(directory, filename, sampleRate, sample->getFormat());
+	std::string temporaryName = name + ".tmp";
+	int fd = open(temporaryName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0)
+		return;
+	bool ok = (write(fd, &header, sizeof(header)) == sizeof(header))
+			  && (write(fd, sample->rawData(), sample->rawSize()) == (ssize_t)sample->rawSize());
+	close(fd);
+	if(!ok || rename(temporaryName.c_str(), name.c_str()) != 0)
+		unlink(temporaryName.c_str());
+}
+
+// Return how many different samples are in memory
+unsigned int SamplePool::size()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	unsigned int count = 0;
+	for(auto& entry : samples_) {
+		if(!entry.second.expired())
+			count++;
+	}
+	return count;
+}
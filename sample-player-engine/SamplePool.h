@@ -0,0 +1,195 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// SamplePool: loads each audio file once and shares it between every
+// player that asks for it. Samples are identified by their path and the
+// sample rate they are converted to. A sample stays in memory for as
+// long as any player is still using it.
+//
+// If a cache directory is given, the first time a file is loaded the
+// decoded samples are also saved in a cache file there. The next time the
+// program starts, the cache is read in one go instead of decoding the file
+// again, as long as the file hasn't changed since. There is no cache
+// unless one is asked for.
+//
+// Files can also be loaded in the background with loadAsync(), which
+// returns straight away. Several files are loaded at once by a small group
+// of worker threads, so setup() doesn't have to wait for a whole kit.
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+// A loaded sound. It never changes once loaded, so it can safely be read
+// by any number of players at once.
+class SampleBuffer {
+public:
+	// How the samples are kept in memory
+	enum Format {
+		FormatFloat = 0,	// 32-bit floats, ready to play
+		FormatInt16			// 16-bit integers: half the memory, converted when read
+	};
+	
+	// Keep the samples in the given format
+	SampleBuffer(std::vector<float>&& samples, float sampleRate, Format format = FormatFloat);
+	
+	// Keep samples that are already 16-bit
+	SampleBuffer(std::vector<int16_t>&& samples, float sampleRate);
+	
+	// Return the float samples, or nullptr if the samples are 16-bit
+	const float *data() const { return format_ == FormatFloat ? samples_.data() : nullptr; }
+	
+	// Return the number of samples and how they are stored
+	unsigned int size() const { return size_; }
+	Format getFormat() const { return format_; }
+	
+	// Return one sample
+	float sample(unsigned int index) const {
+		if(format_ == FormatFloat)
+			return samples_[index];
+		return compactSamples_[index] * kInt16Scale;
+	}
+	
+	// Copy count samples starting at start into output, converting them
+	// to floats if needed
+	void read(unsigned int start, unsigned int count, float *output) const;
+	
+	// Return the sample rate of the samples
+	float getSampleRate() const { return sampleRate_; }
+	
+	// Return the samples as stored and their size in bytes, for saving them
+	const void *rawData() const;
+	unsigned int rawSize() const;
+
+private:
+	static constexpr float kInt16Scale = 1.0 / 32768.0;
+	
+	std::vector<float> samples_;			// Samples, if stored as floats
+	std::vector<int16_t> compactSamples_;	// Samples, if stored as 16-bit integers
+	unsigned int size_;
+	float sampleRate_;
+	Format format_;
+};
+
+class SamplePool {
+public:
+	// A shared, read-only view of a loaded sound
+	typedef std::shared_ptr<const SampleBuffer> Sample;
+	
+	// A sound being loaded in the background. isReady() and get() never
+	// block, so they can be used in render().
+	class Request {
+	public:
+		// Return whether loading has finished (successfully or not)
+		bool isReady() const { return ready_.load(std::memory_order_acquire); }
+		
+		// Return the sound, or an empty pointer if it isn't ready or
+		// couldn't be loaded
+		Sample get() const { return isReady() ? sample_ : Sample(); }
+		
+		// Wait until loading has finished and return the sound. Don't
+		// call this from render().
+		Sample wait() { finished_.wait(); return sample_; }
+		
+	private:
+		friend class SamplePool;
+		Sample sample_;
+		std::atomic<bool> ready_{false};
+		std::promise<void> promise_;
+		std::shared_future<void> finished_ = promise_.get_future().share();
+	};
+	typedef std::shared_ptr<Request> RequestHandle;
+
+	SamplePool() {}
+	
+	// Return the pool shared by the whole program
+	static SamplePool& global();
+	
+	// Return the first channel of an audio file, converted to the given
+	// sample rate (0 to keep the rate of the file) and stored in the given
+	// format. The file is only loaded if it isn't already in memory, and
+	// only decoded if there is no up-to-date cache file for it.
+	// Returns an empty pointer on failure.
+	Sample load(const std::string& filename, float sampleRate = 0,
+				SampleBuffer::Format format = SampleBuffer::FormatFloat);
+	
+	// Start loading an audio file in the background, like load(). Returns
+	// a handle to check on it. Call this from setup(), not from render().
+	RequestHandle loadAsync(const std::string& filename, float sampleRate = 0,
+							SampleBuffer::Format format = SampleBuffer::FormatFloat);
+	
+	// Return how many different samples are in memory
+	unsigned int size();
+	
+	// Keep cache files in the given directory, which is created if it
+	// doesn't exist, or stop using them with an empty string (the default).
+	// Returns false if the directory can't be created. Call this from
+	// setup() before loading anything.
+	bool setCacheDirectory(const std::string& directory);
+	
+	// Destructor: stops the worker threads
+	~SamplePool();
+
+private:
+	// Samples are found by path, sample rate in Hz (0 for the file's own
+	// rate) and format
+	typedef std::tuple<std::string, unsigned int, int> Key;
+	
+	// Run background loads until the pool is destroyed
+	void workerLoop();
+	
+	// Decode an audio file, converting it to the given rate and format
+	Sample decode(const std::string& filename, unsigned int sampleRate, SampleBuffer::Format format);
+	
+	// Load the samples from a cache file, or return an empty pointer if
+	// there is no cache file or it doesn't match the audio file
+	Sample readCache(const std::string& directory, const std::string& filename,
+					 unsigned int sampleRate, SampleBuffer::Format format);
+	
+	// Save samples in a cache file
+	void writeCache(const std::string& directory, const std::string& filename,
+					unsigned int sampleRate, const Sample& sample);
+	
+	// Return the name of the cache file for the given audio file
+	static std::string cacheFilename(const std::string& directory, const std::string& filename,
+									 unsigned int sampleRate, SampleBuffer::Format format);
+	
+	// The pool doesn't keep samples alive itself: they are freed when
+	// the last player using them lets go
+	std::map<Key, std::weak_ptr<const SampleBuffer> > samples_;
+	std::mutex mutex_;
+	std::string cacheDirectory_;	// Where cache files go, or empty for none (guarded by mutex_)
+	
+	// Files being loaded right now, so that two loads of the same file
+	// wait for one decode instead of doing it twice
+	std::map<Key, std::shared_future<Sample> > loading_;
+	
+	// Worker threads and the loads waiting for them. These are ordinary
+	// (not real-time) threads since all they do is read files.
+	std::vector<std::thread> workers_;
+	std::deque<std::function<void()> > jobs_;
+	std::mutex jobsMutex_;
+	std::condition_variable jobsChanged_;
+	bool stopping_ = false;
+};
@@ -0,0 +1,152 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+sample-player-engine: the different ways MonoFilePlayer can get its samples,
+and playing them back at different speeds
+*/
+
+#include <Bela.h>
+#include <vector>
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+#include "MonoFilePlayer.h"
+
+// Name of the sound file (in project folder)
+std::string gFilename = "slow-drum-loop.wav";
+
+// Where to keep the decoded samples, so the next start is quicker. This
+// is outside the project so the cache files aren't copied around with it.
+std::string gCacheDirectory = "/root/.cache/sample-player-engine";
+
+// The same file played in four different ways. The Player slider chooses
+// which one we hear.
+enum {
+	kPlayerMemory = 0,		// Loaded into memory as floats, looping part of the file
+	kPlayerInt16,			// Loaded in the background as 16-bit integers
+	kPlayerMapped,			// Read in place from the mapped WAV file
+	kPlayerStreaming,		// Streamed from disk by a background thread
+	kNumPlayers
+};
+MonoFilePlayer gPlayers[kNumPlayers];
+const char *kPlayerNames[kNumPlayers] = {"in memory, looping with a crossfade",
+										 "16-bit, loaded in the background",
+										 "memory-mapped", "streamed from disk"};
+unsigned int gCurrentPlayer = kPlayerMemory;
+
+// Length of the crossfade where the loop of the first player joins up
+const float kCrossfadeTime = 0.05;
+
+// Buffer the player fills with a block of samples at a time
+std::vector<float> gPlayerBuffer;
+
+// Number of samples the streaming player has missed so far
+unsigned int gLastUnderruns = 0;
+
+// Browser-based GUI to adjust parameters
+Gui gGui;
+GuiController gGuiController;
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Cache files are optional: without them the file is just decoded
+	if(!SamplePool::global().setCacheDirectory(gCacheDirectory))
+		rt_printf("Can't use '%s' for cache files\n", gCacheDirectory.c_str());
+
+	// Start loading the 16-bit copy first, so it loads while the others
+	// are set up
+	gPlayers[kPlayerInt16].setupAsync(gFilename, true, true, context->audioSampleRate,
+									  SampleBuffer::FormatInt16);
+
+	// Load the whole file, converted to the audio sample rate, and loop
+	// the middle half of it
+	MonoFilePlayer& memoryPlayer = gPlayers[kPlayerMemory];
+	if(!memoryPlayer.setup(gFilename, true, true, context->audioSampleRate)) {
+    	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
+    	return false;
+	}
+	memoryPlayer.setLoopPoints(memoryPlayer.size() / 4, 3 * memoryPlayer.size() / 4,
+							   kCrossfadeTime * context->audioSampleRate);
+
+	// Map and stream the same file
+	if(!gPlayers[kPlayerMapped].setupMapped(gFilename, true, true, context->audioSampleRate)) {
+		rt_printf("Error mapping audio file '%s'\n", gFilename.c_str());
+		return false;
+	}
+	if(!gPlayers[kPlayerStreaming].setupStreaming(gFilename)) {
+		rt_printf("Error streaming audio file '%s'\n", gFilename.c_str());
+		return false;
+	}
+
+	// Start with the best quality interpolation. Choosing it here
+	// rather than in render() makes its lookup table in advance.
+	for(unsigned int p = 0; p < kNumPlayers; p++)
+		gPlayers[p].setInterpolation(MonoFilePlayer::InterpolationSinc);
+
+	// Print some useful info
+    rt_printf("Loaded the audio file '%s' with %d frames (%.1f seconds)\n",
+    			gFilename.c_str(), memoryPlayer.size(),
+    			memoryPlayer.size() / context->audioSampleRate);
+
+	// Make space for one block of samples from the player
+	gPlayerBuffer.resize(context->audioFrames);
+
+	// Set up the GUI
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "Sample Player Controller");
+
+	// Arguments: name, default value, minimum, maximum, increment
+	gGuiController.addSlider("Player", kPlayerMemory, 0, kNumPlayers - 1, 1);
+	gGuiController.addSlider("Speed (not when streaming)", 1, 0.25, 4, 0);
+	gGuiController.addSlider("Interpolation (linear, cubic, sinc)", 2, 0, 2, 1);
+
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	// Retrieve values from the sliders
+	unsigned int player = gGuiController.getSliderValue(0);
+	if(player >= kNumPlayers)
+		player = kNumPlayers - 1;
+	float speed = gGuiController.getSliderValue(1);
+	MonoFilePlayer::Interpolation interpolation =
+		(MonoFilePlayer::Interpolation)(int)gGuiController.getSliderValue(2);
+
+	if(player != gCurrentPlayer) {
+		// Start the newly chosen player from the beginning
+		gCurrentPlayer = player;
+		gPlayers[gCurrentPlayer].trigger();
+		rt_printf("Playing the file %s\n", kPlayerNames[gCurrentPlayer]);
+	}
+	gPlayers[gCurrentPlayer].setSpeed(speed);
+	gPlayers[gCurrentPlayer].setInterpolation(interpolation);
+
+	// Get the whole block from the player at once
+	gPlayers[gCurrentPlayer].process(gPlayerBuffer.data(), context->audioFrames);
+
+	for(unsigned int n = 0; n < context->audioFrames; n++) {
+		for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
+			// Write the sample to every audio output channel
+			audioWrite(context, n, channel, gPlayerBuffer[n]);
+		}
+	}
+
+	// Let us know if the disk couldn't keep up with the streaming player
+	unsigned int underruns = gPlayers[kPlayerStreaming].underruns();
+	if(underruns != gLastUnderruns) {
+		rt_printf("Streaming fell behind: %u samples missed so far\n", underruns);
+		gLastUnderruns = underruns;
+	}
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
@@ -0,0 +1,83 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// MultiChannelFilePlayer.cpp: play every channel of a sound file, a block at a time
+
+#include <libraries/AudioFile/AudioFile.h>
+#include <cstring>
+#include "MultiChannelFilePlayer.h"
+
+// Constructor taking the path of a file to load
+MultiChannelFilePlayer::MultiChannelFilePlayer(const std::string& filename, bool loop, bool autostart)
+{
+	setup(filename, loop, autostart);
+}
+
+// Load all the channels of an audio file
+bool MultiChannelFilePlayer::setup(const std::string& filename, bool loop, bool autostart)
+{
+	readPointer_ = 0;
+	isPlaying_ = autostart;
+	loop_ = loop;
+	
+	// Load the file, with one buffer for each channel
+	sampleBuffers_ = AudioFileUtilities::load(filename);
+	
+	// Check for error
+	if(sampleBuffers_.empty() || sampleBuffers_[0].empty()) {
+		sampleBuffers_.clear();
+		isPlaying_ = false;
+		return false;
+	}
+	
+	return true;
+}
+
+// Start playing from the beginning
+void MultiChannelFilePlayer::trigger()
+{
+	if(size() == 0)
+		return;
+	readPointer_ = 0;
+	isPlaying_ = true;
+}
+
+// Fill a block of non-interleaved output
+void MultiChannelFilePlayer::process(float *output, unsigned int outputChannels, unsigned int frames)
+{
+	unsigned int n = 0;
+	while(n < frames && isPlaying_) {
+		// Copy as much as we can before reaching the end of the file,
+		// one channel at a time
+		unsigned int count = size() - readPointer_;
+		if(count > frames - n)
+			count = frames - n;
+		for(unsigned int channel = 0; channel < outputChannels; channel++) {
+			const std::vector<float>& buffer = sampleBuffers_[channel % sampleBuffers_.size()];
+			memcpy(&output[channel * frames + n], &buffer[readPointer_], count * sizeof(float));
+		}
+		n += count;
+		readPointer_ += count;
+		
+		// If we reach the end, decide whether to loop or stop
+		if(readPointer_ >= size()) {
+			readPointer_ = 0;
+			if(!loop_)
+				isPlaying_ = false;
+		}
+	}
+	
+	// Silence for the rest of the block if we stopped
+	if(n < frames) {
+		for(unsigned int channel = 0; channel < outputChannels; channel++)
+			memset(&output[channel * frames + n], 0, (frames - n) * sizeof(float));
+	}
+}
@@ -0,0 +1,52 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+*/
+
+// This class plays a sound file with any number of channels. Each channel
+// is kept in its own buffer, the same way Bela keeps its audio outputs,
+// so a whole block of every channel can be copied out at once.
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+class MultiChannelFilePlayer {
+public:
+	// Constructors: the one with arguments automatically calls setup()
+	MultiChannelFilePlayer() {}
+	MultiChannelFilePlayer(const std::string& filename, bool loop = true, bool autostart = true);
+	
+	// Load all the channels of an audio file. Returns true on success.
+	bool setup(const std::string& filename, bool loop = true, bool autostart = true);
+	
+	// Start or stop the playback
+	void trigger();
+	void stop() { isPlaying_ = false; }
+	
+	// Return the length of the file in frames and its number of channels
+	unsigned int size() { return sampleBuffers_.empty() ? 0 : sampleBuffers_[0].size(); }
+	unsigned int getNumChannels() { return sampleBuffers_.size(); }
+	
+	// Fill a block of non-interleaved output: channel c starts at
+	// output + c * frames, like context->audioOut. If there are more outputs
+	// than channels in the file, the file's channels are repeated, so a
+	// mono file plays on every output and a stereo file on each pair.
+	void process(float *output, unsigned int outputChannels, unsigned int frames);
+	
+	// Destructor
+	~MultiChannelFilePlayer() {}
+	
+private:
+	std::vector<std::vector<float> > sampleBuffers_;	// One buffer per channel of the file
+	unsigned int readPointer_ = 0;						// Next frame to play
+	bool loop_ = false;									// Whether the playback loops at the end
+	bool isPlaying_ = false;							// Whether we are currently playing
+};
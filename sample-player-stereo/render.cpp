@@ -0,0 +1,67 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 7: Playing recorded samples
+sample-player-stereo: play a stereo (or multichannel) sound file a block at a time
+*/
+
+#include <Bela.h>
+#include <vector>
+#include "MultiChannelFilePlayer.h"
+
+// Name of the sound file (in project folder)
+std::string gFilename = "slow-drum-loop.wav";
+
+// Object that handles playing sound from a buffer
+MultiChannelFilePlayer gPlayer;
+
+// Non-interleaved block for when Bela is running with interleaved buffers
+std::vector<float> gPlayerBuffer;
+
+bool setup(BelaContext *context, void *userData)
+{
+	// Load the audio file
+	if(!gPlayer.setup(gFilename)) {
+    	rt_printf("Error loading audio file '%s'\n", gFilename.c_str());
+    	return false;
+	}
+
+	// Print some useful info
+    rt_printf("Loaded the audio file '%s' with %d channels and %d frames (%.1f seconds)\n", 
+    			gFilename.c_str(), gPlayer.getNumChannels(), gPlayer.size(),
+    			gPlayer.size() / context->audioSampleRate);
+
+	// The player writes non-interleaved blocks, so if the audio buffers
+	// are interleaved we need somewhere to put the block first
+	if(context->flags & BELA_FLAG_INTERLEAVED)
+		gPlayerBuffer.resize(context->audioFrames * context->audioOutChannels);
+
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	if(!(context->flags & BELA_FLAG_INTERLEAVED)) {
+		// The audio outputs are laid out the way the player writes them, so
+		// it can fill every channel of the block directly
+		gPlayer.process(context->audioOut, context->audioOutChannels, context->audioFrames);
+		return;
+	}
+	
+	// Otherwise play into our own buffer and write it a sample at a time
+	gPlayer.process(gPlayerBuffer.data(), context->audioOutChannels, context->audioFrames);
+	for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
+		for(unsigned int n = 0; n < context->audioFrames; n++)
+			audioWrite(context, n, channel, gPlayerBuffer[channel * context->audioFrames + n]);
+	}
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
@@ -0,0 +1,88 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 9: Timing
+*/
+
+// EventQueue.cpp: lock-free queue of timestamped parameter changes
+
+#include "EventQueue.h"
+
+// Constructor taking the number of events to make space for
+EventQueue::EventQueue(unsigned int capacity)
+{
+	setup(capacity);
+}
+
+// Allocate the buffer. Rounding the size up to a power of 2 means the
+// pointers can be wrapped with a mask instead of a comparison.
+void EventQueue::setup(unsigned int capacity)
+{
+	unsigned int size = 2;
+	while(size < capacity + 1)
+		size *= 2;
+	events_.resize(size);
+	mask_ = size - 1;
+	readPointer_ = 0;
+	writePointer_ = 0;
+}
+
+// Add an event to the end of the queue
+bool EventQueue::schedule(uint64_t frame, unsigned int target, float value)
+{
+	unsigned int writePointer = writePointer_.load(std::memory_order_relaxed);
+	unsigned int nextPointer = (writePointer + 1) & mask_;
+	
+	// One slot is always left empty so we can tell full from empty
+	if(events_.empty() || nextPointer == readPointer_.load(std::memory_order_acquire))
+		return false;
+	
+	events_[writePointer].frame = frame;
+	events_[writePointer].target = target;
+	events_[writePointer].value = value;
+	
+	// Publish the event only once it is completely written
+	writePointer_.store(nextPointer, std::memory_order_release);
+	return true;
+}
+
+// Take out the next event if it is due
+bool EventQueue::next(uint64_t frame, Event& event)
+{
+	unsigned int readPointer = readPointer_.load(std::memory_order_relaxed);
+	if(readPointer == writePointer_.load(std::memory_order_acquire))
+		return false;	// Nothing in the queue
+	if(events_[readPointer].frame > frame)
+		return false;	// Not due yet
+	
+	event = events_[readPointer];
+	readPointer_.store((readPointer + 1) & mask_, std::memory_order_release);
+	return true;
+}
+
+// Return how long until the next event, up to maxFrames
+unsigned int EventQueue::framesUntilNext(uint64_t currentFrame, unsigned int maxFrames)
+{
+	unsigned int readPointer = readPointer_.load(std::memory_order_relaxed);
+	if(readPointer == writePointer_.load(std::memory_order_acquire))
+		return maxFrames;
+	
+	uint64_t frame = events_[readPointer].frame;
+	if(frame <= currentFrame)
+		return 0;
+	if(frame - currentFrame >= maxFrames)
+		return maxFrames;
+	return frame - currentFrame;
+}
+
+// Return whether the queue is empty
+bool EventQueue::empty()
+{
+	return readPointer_.load(std::memory_order_acquire) == writePointer_.load(std::memory_order_acquire);
+}
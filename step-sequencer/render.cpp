@@ -17,6 +17,7 @@ step-sequencer-metronome: cycles through a sequence of frequencies at a regular
 #include <vector>
 
 #include "Wavetable.h"	// This is needed for the Wavetable class
+#include "EventQueue.h"	// Schedules the steps at exact frames
 
 // Constants that define the program behaviour
 const unsigned int kWavetableSize = 512;
@@ -27,11 +28,18 @@ const unsigned int kLedPin = 0;				// Digital out for LED
 const unsigned int kCVOutPin = 0;			// Analog out for CV (original Bela only)
 const unsigned int kInputTempo = 0;			// Which analog input to read
 
-// TODO: declare global variables here for counting time
-unsigned int gMetronomeCounter = 0;
+// Lengths of a step and of the LED flash, in samples
 unsigned int gMetronomeInterval = 0;
 unsigned int gLEDInterval = 0;
 
+// Events that drive the sequencer. Rather than counting every sample,
+// each step schedules the next one at the exact frame it should happen.
+enum {
+	kEventStep = 0,		// Go to the step given by the event value
+	kEventLedOff		// Turn the LED off partway through a step
+};
+EventQueue gEvents;
+
 // Browser-based oscilloscope
 Scope gScope;
 
@@ -41,6 +49,7 @@ Wavetable gOscillators[2];
 // Step sequencer contents
 std::vector<float> gSequencerBuffer = {36, 48, 39, 51, 53, 41, 55, 43};
 unsigned int gSequencerLocation = 0;
+float gCV = 0;		// Control voltage for the current step
 
 bool setup(BelaContext *context, void *userData)
 {
@@ -71,7 +80,13 @@ bool setup(BelaContext *context, void *userData)
 	// Set up the oscilloscope
 	gScope.setup(2, context->audioSampleRate);
 	
-	// TODO: initialise the metronome and LED intervals according to sample rate
+	// Initialise the metronome and LED intervals according to sample rate
+	gMetronomeInterval = 0.5 * context->audioSampleRate;
+	gLEDInterval = 0.05 * context->audioSampleRate;
+	
+	// Make space for the events and start the sequence at the first frame
+	gEvents.setup(16);
+	gEvents.schedule(0, kEventStep, 0);
 	
 	// Set up the digital pins
 	pinMode(context, 0, kLedPin, OUTPUT);
@@ -81,67 +96,68 @@ bool setup(BelaContext *context, void *userData)
 
 void render(BelaContext *context, void *userData)
 {
-    for(unsigned int n = 0; n < context->audioFrames; n++) {
-       	// TODO: read the analog input to get the current tempo
-		float input = analogRead(context, n/2, kInputTempo);
-		float bpm = map(input, 0, 3.3/4.096, 40, 500);
-		gMetronomeInterval = 60.0 * context->audioSampleRate / bpm;
-    	float out = 0;
-    	
-    	// Get current frequency based on where we are in the sequencer
-    	float midiNote = gSequencerBuffer[gSequencerLocation];
-    	float frequency = 440.0 * powf(2.0, (midiNote - 69.0) / 12.0);
-    	
-    	// Calculate frequences of each of two oscillators
-		float frequencies[2];
-		frequencies[0] = frequency * (1.0 + kDetune);
-		frequencies[1] = frequency * (1.0 - kDetune);
-
-    	for(unsigned int i = 0; i < 2; i++) {
-    		gOscillators[i].setFrequency(frequencies[i]);
-			out += kAmplitude * gOscillators[i].process();
-    	}
-    	
-    	// TODO: check if enough time has elapsed, and increment
-    	// the sequence location if so, looping around when you reach
-    	// the end of the sequence
-    	
-    	if(++gMetronomeCounter >= gMetronomeInterval) {
-    		// reset the counter and advance the sequence
-    		
-    		gMetronomeCounter = 0;
-    		
-    		gSequencerLocation++;
-    		if(gSequencerLocation >= gSequencerBuffer.size())
-    			gSequencerLocation = 0;
-    		
-    	}
-
-    	// TODO: turn on the LED on if we are early enough in the tick
-		
-		if(gMetronomeCounter < gLEDInterval) {
-			digitalWriteOnce(context, n, kLedPin, HIGH);
-		} 
-		else {
-			digitalWriteOnce(context, n, kLedPin, LOW);
+	// Read the analog input to get the current tempo. This is only
+	// needed when scheduling the next step, so once per block is enough.
+	float input = analogRead(context, 0, kInputTempo);
+	float bpm = map(input, 0, 3.3/4.096, 40, 500);
+	gMetronomeInterval = 60.0 * context->audioSampleRate / bpm;
+	
+	uint64_t blockStart = context->audioFramesElapsed;
+	unsigned int n = 0;
+	
+	while(n < context->audioFrames) {
+		// Handle any events that are due at this frame
+		EventQueue::Event event;
+		while(gEvents.next(blockStart + n, event)) {
+			if(event.target == kEventStep) {
+				// Get the current frequency based on where we are in the sequencer
+				gSequencerLocation = event.value;
+				float midiNote = gSequencerBuffer[gSequencerLocation];
+				float frequency = 440.0 * powf(2.0, (midiNote - 69.0) / 12.0);
+				
+				// Set the frequencies of each of two oscillators
+				gOscillators[0].setFrequency(frequency * (1.0 + kDetune));
+				gOscillators[1].setFrequency(frequency * (1.0 - kDetune));
+				
+				// Convert the MIDI note to a CV based on a 1V/octave standard
+				float octaves = (midiNote - 36.0) / 12.0;
+				gCV = octaves / 5.0;	// 1V per octave; scale is 0-5V
+				if(context->analogOutChannels != 0)
+					analogWrite(context, n/2, kCVOutPin, gCV);
+				
+				// Turn the LED on for the start of the tick
+				digitalWrite(context, n, kLedPin, HIGH);
+				
+				// Schedule the LED to turn off, then the next step, looping
+				// around when we reach the end of the sequence
+				unsigned int nextLocation = gSequencerLocation + 1;
+				if(nextLocation >= gSequencerBuffer.size())
+					nextLocation = 0;
+				gEvents.schedule(event.frame + gLEDInterval, kEventLedOff, 0);
+				gEvents.schedule(event.frame + gMetronomeInterval, kEventStep, nextLocation);
+			}
+			else if(event.target == kEventLedOff) {
+				digitalWrite(context, n, kLedPin, LOW);
+			}
 		}
 		
-		// Write the sample to every audio output channel            
-    	for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
-    		audioWrite(context, n, channel, out);
-    	}
-    	
-    	// Convert the MIDI note to a CV based on a 1V/octave standard
-    	float octaves = (midiNote - 36.0) / 12.0;
-    	float cv = octaves / 5.0;	// 1V per octave; scale is 0-5V
-    	
-    	if(context->analogOutChannels != 0) {
-    		analogWriteOnce(context, n/2, kCVOutPin, cv);
-    	}
-    	
-    	// Write the output to the oscilloscope
-    	gScope.log(out, cv);    
-    }
+		// Nothing changes until the next event, so just run the oscillators
+		unsigned int end = n + gEvents.framesUntilNext(blockStart + n, context->audioFrames - n);
+		for(; n < end; n++) {
+			float out = 0;
+			for(unsigned int i = 0; i < 2; i++) {
+				out += kAmplitude * gOscillators[i].process();
+			}
+			
+			// Write the sample to every audio output channel            
+			for(unsigned int channel = 0; channel < context->audioOutChannels; channel++) {
+				audioWrite(context, n, channel, out);
+			}
+			
+			// Write the output to the oscilloscope
+			gScope.log(out, gCV);
+		}
+	}
 }
 
 void cleanup(BelaContext *context, void *userData)
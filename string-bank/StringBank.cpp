@@ -0,0 +1,133 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// StringBank.cpp: many plucked strings playing together
+
+#include <cmath>
+#include <cstring>
+#include "StringBank.h"
+
+// Set up the strings
+void StringBank::setup(float sampleRate, unsigned int numVoices, float lowestFrequency)
+{
+	if(numVoices < 1)
+		numVoices = 1;
+	else if(numVoices > kMaxVoices)
+		numVoices = kMaxVoices;
+	
+	voices_.resize(numVoices);
+	notes_.assign(numVoices, -1);
+	voiceVersions_.assign(numVoices, settingsVersion_);
+	nextUpdate_ = 0;
+	for(unsigned int v = 0; v < numVoices; v++) {
+		voices_[v].setup(sampleRate, lowestFrequency);
+		voices_[v].setParameters(voices_[v].getFrequency(), decayTime_, brightness_);
+	}
+}
+
+// Pluck a string at the pitch of the given MIDI note
+void StringBank::noteOn(int note, float velocity)
+{
+	if(voices_.empty())
+		return;
+	
+	// Use a silent string if there is one, otherwise the quietest
+	unsigned int chosen = 0;
+	for(unsigned int v = 0; v < voices_.size(); v++) {
+		if(!voices_[v].isActive()) {
+			chosen = v;
+			break;
+		}
+		if(voices_[v].level() < voices_[chosen].level())
+			chosen = v;
+	}
+	
+	// The new note gets the latest settings too, without waiting for
+	// updateVoices() to reach it
+	voices_[chosen].setParameters(440.0 * powf(2.0, (note - 69.0) / 12.0),
+								  decayTime_, brightness_);
+	voiceVersions_[chosen] = settingsVersion_;
+	voices_[chosen].pluck(velocity);
+	notes_[chosen] = note;
+}
+
+// Damp the strings playing the given MIDI note
+void StringBank::noteOff(int note)
+{
+	for(unsigned int v = 0; v < voices_.size(); v++) {
+		if(notes_[v] == note) {
+			voices_[v].release();
+			notes_[v] = -1;
+		}
+	}
+}
+
+// Set the decay time of every string, passed on over the next few blocks
+void StringBank::setDecayTime(float seconds)
+{
+	decayTime_ = seconds;
+	settingsVersion_++;
+}
+
+// Set the brightness of every string, passed on over the next few blocks
+void StringBank::setBrightness(float brightness)
+{
+	brightness_ = brightness;
+	settingsVersion_++;
+}
+
+// Give the latest settings to up to kUpdatesPerBlock ringing strings,
+// carrying on from where the last block stopped. Silent strings are just
+// marked as done, since noteOn() sets them up when they are next plucked.
+void StringBank::updateVoices()
+{
+	unsigned int updated = 0;
+	for(unsigned int i = 0; i < voices_.size() && updated < kUpdatesPerBlock; i++) {
+		unsigned int v = nextUpdate_;
+		nextUpdate_ = (nextUpdate_ + 1) % voices_.size();
+		if(voiceVersions_[v] == settingsVersion_)
+			continue;
+		voiceVersions_[v] = settingsVersion_;
+		if(!voices_[v].isActive())
+			continue;
+		voices_[v].setParameters(voices_[v].getFrequency(), decayTime_, brightness_);
+		updated++;
+	}
+}
+
+// Set where every string is plucked
+void StringBank::setPluckPosition(float position)
+{
+	for(unsigned int v = 0; v < voices_.size(); v++)
+		voices_[v].setPluckPosition(position);
+}
+
+// Return how many strings are sounding
+unsigned int StringBank::activeVoices()
+{
+	unsigned int count = 0;
+	for(unsigned int v = 0; v < voices_.size(); v++) {
+		if(voices_[v].isActive())
+			count++;
+	}
+	return count;
+}
+
+// Fill a block with all the strings mixed together
+void StringBank::process(float *output, unsigned int frames)
+{
+	updateVoices();
+	
+	memset(output, 0, frames * sizeof(float));
+	for(unsigned int v = 0; v < voices_.size(); v++)
+		voices_[v].process(output, frames);
+}
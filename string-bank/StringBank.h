@@ -0,0 +1,78 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// StringBank: a set of StringVoice strings that can play many notes at
+// once. Notes are given as MIDI note numbers; when every string is busy,
+// the quietest one is reused. Each string works out a whole block at a
+// time, so dozens of them can ring together.
+//
+// Changing the decay time or brightness means working out new filter
+// coefficients for every string. Rather than doing them all at once, a few
+// ringing strings are updated in each block, and a string that is plucked
+// gets the new settings straight away.
+
+#pragma once
+
+#include <vector>
+#include "StringVoice.h"
+
+class StringBank {
+public:
+	// Most strings in one bank
+	static const unsigned int kMaxVoices = 64;
+	
+	// Most strings given new settings in each block
+	static const unsigned int kUpdatesPerBlock = 8;
+	
+	// Constructor
+	StringBank() {}
+	
+	// Set up the given number of strings, each able to go down to
+	// lowestFrequency
+	void setup(float sampleRate, unsigned int numVoices = 32, float lowestFrequency = 30.0);
+	
+	// Pluck a string at the pitch of the given MIDI note. velocity goes
+	// from 0 to 1.
+	void noteOn(int note, float velocity);
+	
+	// Damp the strings playing the given MIDI note
+	void noteOff(int note);
+	
+	// Settings used by every string: see StringVoice
+	void setDecayTime(float seconds);
+	void setBrightness(float brightness);
+	void setPluckPosition(float position);
+	
+	// Return how many strings are sounding
+	unsigned int activeVoices();
+	
+	// Fill a block with all the strings mixed together
+	void process(float *output, unsigned int frames);
+	
+	// Destructor
+	~StringBank() {}
+
+private:
+	// Give the latest settings to the next few strings that don't have them
+	void updateVoices();
+	
+	std::vector<StringVoice> voices_;
+	std::vector<int> notes_;		// MIDI note each string is playing, or -1
+	
+	// Settings for every string. settingsVersion_ counts the changes, and
+	// voiceVersions_ holds the last version each string was given.
+	float decayTime_ = 4.0;
+	float brightness_ = 0.5;
+	unsigned int settingsVersion_ = 0;
+	std::vector<unsigned int> voiceVersions_;
+	unsigned int nextUpdate_ = 0;	// String to look at first in updateVoices()
+};
@@ -0,0 +1,243 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// StringVoice.cpp: a Karplus-Strong plucked string
+
+#include <cmath>
+#include <cstring>
+#include "StringVoice.h"
+
+// Longest run worked out at once in process()
+static const unsigned int kMaxRun = 64;
+
+// Below this level the string is treated as silent
+static const float kSilenceThreshold = 0.0001;
+
+// Set the sample rate and make space for the lowest string
+void StringVoice::setup(float sampleRate, float lowestFrequency)
+{
+	sampleRate_ = sampleRate;
+	
+	// Room for the longest loop plus the filter taps, rounded up to a power of 2
+	unsigned int longest = sampleRate / lowestFrequency + kNumTaps + 1;
+	size_ = 1;
+	while(size_ < longest)
+		size_ *= 2;
+	mask_ = size_ - 1;
+	buffer_.assign(size_ + kGuardSamples, 0);
+	writePointer_ = 0;
+	active_ = false;
+	level_ = 0;
+	
+	calculateCoefficients();
+}
+
+// Set the frequency and recalculate the coefficients
+void StringVoice::setFrequency(float frequency)
+{
+	frequency_ = frequency;
+	calculateCoefficients();
+}
+
+// Set the decay time and recalculate the coefficients
+void StringVoice::setDecayTime(float seconds)
+{
+	decayTime_ = seconds;
+	calculateCoefficients();
+}
+
+// Set the brightness and recalculate the coefficients
+void StringVoice::setBrightness(float brightness)
+{
+	if(brightness < 0)
+		brightness = 0;
+	else if(brightness > 1)
+		brightness = 1;
+	brightness_ = brightness;
+	calculateCoefficients();
+}
+
+// Set all three settings, then recalculate the coefficients once
+void StringVoice::setParameters(float frequency, float decayTime, float brightness)
+{
+	if(brightness < 0)
+		brightness = 0;
+	else if(brightness > 1)
+		brightness = 1;
+	frequency_ = frequency;
+	decayTime_ = decayTime;
+	brightness_ = brightness;
+	calculateCoefficients();
+}
+
+// Work out the loop length and filter coefficients
+void StringVoice::calculateCoefficients()
+{
+	// One-zero lowpass: (1 - s) * x[n] + s * x[n-1]. s = 0.5 is the
+	// original Karplus-Strong average; smaller is brighter.
+	float s = 0.05 + 0.45 * (1.0 - brightness_);
+	
+	// The loop has to add up to one period. The interpolator delays by
+	// about 1 + fraction and the lowpass by about s, so start with the rest
+	// as the delay line length, then correct it below.
+	float period = sampleRate_ / frequency_;
+	float loopDelay = period - 1.0 - s;
+	float w = 2.0 * M_PI / period;
+	float taps[kNumTaps];
+	
+	for(unsigned int iteration = 0; iteration < 3; iteration++) {
+		if(loopDelay < 1.0)
+			loopDelay = 1.0;
+		if(loopDelay > size_ - kNumTaps - 1)
+			loopDelay = size_ - kNumTaps - 1;
+		delay_ = loopDelay;
+		float x = 1.0 + (loopDelay - delay_);
+		
+		// Cubic Lagrange interpolation through 4 samples, newest first
+		float h[4];
+		h[0] = -(x - 1.0) * (x - 2.0) * (x - 3.0) / 6.0;
+		h[1] = x * (x - 2.0) * (x - 3.0) / 2.0;
+		h[2] = -x * (x - 1.0) * (x - 3.0) / 2.0;
+		h[3] = x * (x - 1.0) * (x - 2.0) / 6.0;
+		
+		// Combine the interpolator and lowpass into one filter, newest first
+		taps[0] = (1.0 - s) * h[0];
+		for(unsigned int k = 1; k < 4; k++)
+			taps[k] = (1.0 - s) * h[k] + s * h[k - 1];
+		taps[4] = s * h[3];
+		
+		// The filter's delay isn't quite the same at every frequency. Find
+		// its real delay at the fundamental, and adjust the loop so the
+		// string is exactly in tune.
+		float re = 0, im = 0;
+		for(unsigned int k = 0; k < kNumTaps; k++) {
+			re += taps[k] * cosf(w * k);
+			im -= taps[k] * sinf(w * k);
+		}
+		float filterDelay = -atan2f(im, re) / w;
+		loopDelay += period - (delay_ + filterDelay);
+	}
+	
+	// Each time round the loop loses enough to die away by 60dB over the
+	// decay time, or the much shorter release time once damped. The lowpass
+	// takes away a little more, so high notes die sooner, as on a real string.
+	float decay = released_ ? releaseTime_ : decayTime_;
+	if(decay < 0.01)
+		decay = 0.01;
+	float gain = powf(10.0, -3.0 * period / (decay * sampleRate_));
+	
+	// Store the filter oldest sample first, to match the order in the buffer
+	for(unsigned int k = 0; k < kNumTaps; k++)
+		coefficients_[k] = gain * taps[kNumTaps - 1 - k];
+}
+
+// Random number from -1 to 1, from a simple linear congruential generator
+float StringVoice::noise()
+{
+	randomSeed_ = randomSeed_ * 1664525 + 1013904223;
+	return (float)(int)randomSeed_ / 2147483648.0;
+}
+
+// Fill the loop with a burst of noise
+void StringVoice::pluck(float amplitude)
+{
+	released_ = false;
+	calculateCoefficients();
+	
+	// Fill every sample the loop filter is about to read
+	unsigned int length = delay_ + kNumTaps;
+	unsigned int start = writePointer_ - length;
+	
+	// Duller strings get duller noise, using a one-pole lowpass
+	float smoothing = 0.2 + 0.8 * brightness_;
+	float smoothed = 0;
+	for(unsigned int n = 0; n < length; n++) {
+		smoothed += smoothing * (noise() - smoothed);
+		buffer_[(start + n) & mask_] = amplitude * smoothed;
+	}
+	
+	// Plucking at a point along the string cancels the harmonics that have
+	// a node there: subtract a delayed copy of the noise. Going backwards
+	// means the copy hasn't been changed yet.
+	unsigned int pluckDelay = pluckPosition_ * length;
+	if(pluckDelay > 0) {
+		for(unsigned int n = length - 1; n >= pluckDelay; n--)
+			buffer_[(start + n) & mask_] -= buffer_[(start + n - pluckDelay) & mask_];
+	}
+	
+	// Keep the copy at the end of the buffer up to date
+	for(unsigned int n = 0; n < kGuardSamples; n++)
+		buffer_[size_ + n] = buffer_[n];
+	
+	active_ = true;
+	level_ = amplitude;
+}
+
+// Damp the string so it dies away quickly
+void StringVoice::release()
+{
+	released_ = true;
+	calculateCoefficients();
+}
+
+// Add the next block of the string's sound into output
+void StringVoice::process(float *output, unsigned int frames)
+{
+	if(!active_)
+		return;
+	
+	float y[kMaxRun];
+	float peak = 0;
+	
+	unsigned int n = 0;
+	while(n < frames) {
+		// Work out as many samples at once as we can: no more than one loop
+		// length, so every input was written before this run, and stopping
+		// where the reads or writes reach the end of the buffer
+		unsigned int writeStart = writePointer_ & mask_;
+		unsigned int readStart = (writePointer_ - delay_ - kGuardSamples) & mask_;
+		unsigned int run = frames - n;
+		if(run > kMaxRun)
+			run = kMaxRun;
+		if(run > delay_)
+			run = delay_;
+		if(run > size_ - writeStart)
+			run = size_ - writeStart;
+		if(run > size_ - readStart)
+			run = size_ - readStart;
+		
+		// The loop filter, with no feedback inside the run
+		const float *x = &buffer_[readStart];
+		for(unsigned int i = 0; i < run; i++) {
+			y[i] = coefficients_[0] * x[i] + coefficients_[1] * x[i + 1]
+				   + coefficients_[2] * x[i + 2] + coefficients_[3] * x[i + 3]
+				   + coefficients_[4] * x[i + 4];
+		}
+		
+		// Put the run back into the loop and into the output
+		memcpy(&buffer_[writeStart], y, run * sizeof(float));
+		for(unsigned int i = writeStart; i < writeStart + run && i < kGuardSamples; i++)
+			buffer_[size_ + i] = buffer_[i];
+		for(unsigned int i = 0; i < run; i++) {
+			output[n + i] += y[i];
+			peak = fmaxf(peak, fabsf(y[i]));
+		}
+		
+		writePointer_ += run;
+		n += run;
+	}
+	
+	// Stop once the string has died away
+	level_ = peak;
+	if(peak < kSilenceThreshold)
+		active_ = false;
+}
@@ -0,0 +1,113 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+*/
+
+// StringVoice: a plucked string made from a delay line (Karplus-Strong).
+// A burst of noise goes round and round the delay line, which sets the
+// pitch, through a loop filter that takes away a little of the high
+// frequencies each time, so the sound starts bright and mellows as it
+// dies away, like a real string.
+//
+// The loop filter is a short FIR: a cubic interpolator for the fraction
+// of a sample that tunes the string exactly, followed by a one-zero
+// lowpass whose setting gives the brightness. Like the Filter class, the
+// coefficients are only recalculated when a setting changes.
+//
+// Because the loop filter only looks at samples at least one period old,
+// a whole period's worth of output can be worked out at once, so the
+// inner loop of process() has no feedback in it and can be vectorised.
+
+#pragma once
+
+#include <vector>
+
+class StringVoice {
+public:
+	// Constructor
+	StringVoice() {}
+	
+	// Set the sample rate and make space for strings down to the given
+	// frequency. Call before anything else.
+	void setup(float sampleRate, float lowestFrequency = 30.0);
+	
+	// Set the frequency of the string in Hz
+	void setFrequency(float frequency);
+	
+	// Set the time in seconds for a plucked note to die away by 60dB
+	void setDecayTime(float seconds);
+	
+	// Set the brightness from 0 (dull, like nylon) to 1 (bright, like steel)
+	void setBrightness(float brightness);
+	
+	// Set the frequency, decay time and brightness together, working out
+	// the coefficients only once
+	void setParameters(float frequency, float decayTime, float brightness);
+	
+	// Return the frequency of the string in Hz
+	float getFrequency() { return frequency_; }
+	
+	// Set where the string is plucked, as a fraction of its length from
+	// the end (0 to 0.5). Closer to the end sounds thinner.
+	void setPluckPosition(float position) { pluckPosition_ = position; }
+	
+	// Pluck the string with the given amplitude
+	void pluck(float amplitude);
+	
+	// Damp the string, as if a finger were put on it
+	void release();
+	
+	// Indicate whether the string is still making sound
+	bool isActive() { return active_; }
+	
+	// Return the loudest sample in the last block, for choosing which voice
+	// to reuse
+	float level() { return level_; }
+	
+	// Add the next block of the string's sound into output
+	void process(float *output, unsigned int frames);
+	
+	// Destructor
+	~StringVoice() {}
+
+private:
+	// Work out the loop length and filter coefficients from the settings
+	void calculateCoefficients();
+	
+	// Random number from -1 to 1 for the noise burst
+	float noise();
+	
+	// Settings
+	float sampleRate_ = 44100.0;
+	float frequency_ = 440.0;
+	float decayTime_ = 4.0;
+	float releaseTime_ = 0.1;
+	float brightness_ = 0.5;
+	float pluckPosition_ = 0.2;
+	bool released_ = false;
+	
+	// The delay line. It is a power of 2 long, with a copy of the first
+	// kGuardSamples at the end so all the filter taps can be read in a row.
+	std::vector<float> buffer_;
+	unsigned int size_ = 0;
+	unsigned int mask_ = 0;
+	unsigned int writePointer_ = 0;
+	
+	// The loop: delay_ whole samples, then the loop filter
+	static const unsigned int kNumTaps = 5;
+	static const unsigned int kGuardSamples = kNumTaps - 1;
+	unsigned int delay_ = 100;
+	float coefficients_[kNumTaps];	// Oldest sample first, including the decay
+	
+	// State
+	bool active_ = false;
+	float level_ = 0;
+	unsigned int randomSeed_ = 1;
+};
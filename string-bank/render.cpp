@@ -0,0 +1,126 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+C++ Real-Time Audio Programming with Bela - Lecture 11: Circular buffers
+string-bank: dozens of plucked strings, each one a delay line with a filter
+*/
+
+#include <Bela.h>
+#include <vector>
+#include "StringBank.h"
+#include <libraries/Gui/Gui.h>
+#include <libraries/GuiController/GuiController.h>
+
+// Bela slider Gui
+Gui gGui;
+GuiController gGuiController;
+
+// The strings, and a block of their output
+StringBank gStrings;
+std::vector<float> gOutputBuffer;
+const unsigned int kNumStrings = 48;
+const float kOutputGain = 0.2;
+
+// A sequence of chords, strummed up and down as fast arpeggios. With long
+// decay times the notes pile up, so many strings ring at once.
+const unsigned int kNotesPerChord = 6;
+const int kChords[][kNotesPerChord] = {
+	{40, 47, 52, 56, 59, 64},	// E major
+	{45, 52, 57, 61, 64, 69},	// A major
+	{38, 45, 50, 54, 57, 62},	// D major
+	{43, 47, 50, 55, 59, 67}	// G major
+};
+const unsigned int kNumChords = sizeof(kChords) / sizeof(kChords[0]);
+const unsigned int kStepsPerChord = 4 * kNotesPerChord;
+
+// Sequencer state
+unsigned int gStepCounter = 0;		// Frames until the next note
+unsigned int gStep = 0;				// Which note of the sequence is next
+
+// Set to true to print how many strings are ringing every couple of seconds
+const bool kPrintVoiceCount = false;
+unsigned int gPrintCounter = 0;		// Frames until the next voice count
+
+// Last slider values, so the strings are only updated when they change
+float gDecayTime = -1, gBrightness = -1, gPluckPosition = -1;
+
+bool setup(BelaContext *context, void *userData)
+{
+	gStrings.setup(context->audioSampleRate, kNumStrings);
+	gOutputBuffer.resize(context->audioFrames);
+	
+	// set up the Gui
+	gGui.setup(context->projectName);
+	gGuiController.setup(&gGui, "String Bank Controller");
+	
+	//args: name, default value, minimum, maximum, increment (no fixed increment)
+	gGuiController.addSlider("Decay time", 6.0, 0.2, 20.0, 0);
+	gGuiController.addSlider("Brightness", 0.5, 0, 1, 0);
+	gGuiController.addSlider("Pluck position", 0.2, 0.02, 0.5, 0);
+	gGuiController.addSlider("Notes per second", 12, 1, 40, 0);
+	
+	return true;
+}
+
+void render(BelaContext *context, void *userData)
+{
+	// Update the strings only when a slider has moved
+	float decayTime = gGuiController.getSliderValue(0);
+	float brightness = gGuiController.getSliderValue(1);
+	float pluckPosition = gGuiController.getSliderValue(2);
+	if(decayTime != gDecayTime) {
+		gStrings.setDecayTime(decayTime);
+		gDecayTime = decayTime;
+	}
+	if(brightness != gBrightness) {
+		gStrings.setBrightness(brightness);
+		gBrightness = brightness;
+	}
+	if(pluckPosition != gPluckPosition) {
+		gStrings.setPluckPosition(pluckPosition);
+		gPluckPosition = pluckPosition;
+	}
+	unsigned int stepInterval = context->audioSampleRate / gGuiController.getSliderValue(3);
+	
+	// Play the next note of the arpeggio if it is due in this block. The
+	// strings run a whole block at a time, so notes start at block boundaries.
+	if(gStepCounter < context->audioFrames) {
+		unsigned int chord = (gStep / kStepsPerChord) % kNumChords;
+		unsigned int position = gStep % (2 * kNotesPerChord);
+		unsigned int note = (position < kNotesPerChord) ? position : 2 * kNotesPerChord - 1 - position;
+		float velocity = (gStep % kNotesPerChord == 0) ? 0.9 : 0.6;
+		gStrings.noteOn(kChords[chord][note], velocity);
+		
+		gStep++;
+		gStepCounter += stepInterval;
+	}
+	gStepCounter -= context->audioFrames;
+	
+	// Run every string for the whole block
+	gStrings.process(gOutputBuffer.data(), context->audioFrames);
+	
+	for(unsigned int n = 0; n < context->audioFrames; n++) {
+		float out = kOutputGain * gOutputBuffer[n];
+		audioWrite(context, n, 0, out);
+		audioWrite(context, n, 1, out);
+	}
+	
+	// Every couple of seconds, show how many strings are ringing
+	if(kPrintVoiceCount) {
+		if(gPrintCounter < context->audioFrames) {
+			rt_printf("%d strings sounding\n", gStrings.activeVoices());
+			gPrintCounter += 2.0 * context->audioSampleRate;
+		}
+		gPrintCounter -= context->audioFrames;
+	}
+}
+
+void cleanup(BelaContext *context, void *userData)
+{
+
+}
@@ -0,0 +1,74 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 6: Analog I/O
+*/
+
+// SmoothedParameter.cpp: a linearly interpolated control-rate parameter
+
+#include "SmoothedParameter.h"
+
+// Constructor
+SmoothedParameter::SmoothedParameter() : SmoothedParameter(16) {}
+
+// Constructor specifying how many samples between updates
+SmoothedParameter::SmoothedParameter(unsigned int interval)
+{
+	setup(interval);
+}
+
+// Set how many samples between updates, and start again with no value
+void SmoothedParameter::setup(unsigned int interval)
+{
+	interval_ = (interval > 0) ? interval : 1;
+	currentValue_ = 0;
+	increment_ = 0;
+	counter_ = 0;
+	hasValue_ = false;
+}
+
+// Return whether the last interval has finished
+bool SmoothedParameter::needsUpdate()
+{
+	return (counter_ == 0);
+}
+
+// Ramp to the target over the next interval
+void SmoothedParameter::setTarget(float target)
+{
+	if(!hasValue_) {
+		// Nothing to smooth from yet
+		setValue(target);
+		counter_ = interval_;
+		return;
+	}
+	
+	increment_ = (target - currentValue_) / interval_;
+	counter_ = interval_;
+}
+
+// Jump to a value
+void SmoothedParameter::setValue(float value)
+{
+	currentValue_ = value;
+	increment_ = 0;
+	counter_ = 0;
+	hasValue_ = true;
+}
+
+// Generate and return the next value
+float SmoothedParameter::process()
+{
+	if(counter_ > 0) {
+		counter_--;
+		currentValue_ += increment_;
+	}
+	
+	return currentValue_;
+}
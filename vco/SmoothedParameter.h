@@ -0,0 +1,56 @@
+/*
+ ____  _____ _        _    
+| __ )| ____| |      / \   
+|  _ \|  _| | |     / _ \  
+| |_) | |___| |___ / ___ \ 
+|____/|_____|_____/_/   \_\
+
+http://bela.io
+
+C++ Real-Time Audio Programming with Bela - Lecture 6: Analog I/O
+*/
+
+// SmoothedParameter.h: a control-rate parameter. A new target is calculated
+// once every few samples and the output moves linearly towards it in between,
+// so expensive control calculations don't need to run on every sample.
+
+#pragma once
+
+class SmoothedParameter {
+public:
+	// Constructor
+	SmoothedParameter();
+	
+	// Constructor specifying how many samples between updates
+	SmoothedParameter(unsigned int interval);
+	
+	// Set how many samples there are between updates
+	void setup(unsigned int interval);
+	
+	// Return whether it is time to give the parameter a new target
+	bool needsUpdate();
+	
+	// Set the value to reach at the end of the next interval. The first
+	// target after setup() is jumped to straight away.
+	void setTarget(float target);
+	
+	// Jump to a value without smoothing
+	void setValue(float value);
+	
+	// Generate and return the next interpolated value
+	float process();
+	
+	// Return the current value
+	float getValue() { return currentValue_; }
+	
+	// Destructor
+	~SmoothedParameter() {}
+
+private:
+	// State variables, not accessible to the outside world
+	unsigned int interval_;
+	float currentValue_;
+	float increment_;
+	int counter_;
+	bool hasValue_;			// Whether a value has been set since setup()
+};
@@ -19,6 +19,7 @@ vco: a project to be converted from GUI controls into analog input controls
 #include <vector>
 
 #include "wavetable.h"	// This is needed for the Wavetable class
+#include "SmoothedParameter.h"	// Control-rate parameters
 
 // Constants that define the program behaviour
 const unsigned int kWavetableSize = 512;
@@ -33,6 +34,11 @@ Scope gScope;
 // Wavetable oscillator
 Wavetable gOscillators[2];
 
+// The analog inputs are read and converted to parameters once every
+// kControlInterval samples, with the parameters smoothed in between
+const unsigned int kControlInterval = 16;
+SmoothedParameter gFrequency, gAmplitude, gDetune;
+
 bool setup(BelaContext *context, void *userData)
 {
 	std::vector<float> wavetable;
@@ -75,6 +81,11 @@ bool setup(BelaContext *context, void *userData)
 
 	// Set up the oscilloscope
 	gScope.setup(1, context->audioSampleRate);
+	
+	// Set up the control-rate parameters
+	gFrequency.setup(kControlInterval);
+	gAmplitude.setup(kControlInterval);
+	gDetune.setup(kControlInterval);
 
 	return true;
 }
@@ -87,22 +98,26 @@ void render(BelaContext *context, void *userData)
 	for(unsigned int n = 0; n < context->audioFrames; n++) {
     	float out = 0;
 	
-	float input0 = analogRead(context, n/2, 0);
-	float input1 = analogRead(context, n/2, 1);
-	float input2 = analogRead(context, n/2, 2);
-	
-	float frequency = 55.0 * powf(2.0, input0 * 4.096); 
-	float amplitudeDB = map(input1, 0, 3.3 / 4.096, -40, -6);
-	float detune = map(input2, 0, 3.3 / 4.096, 0, 0.05);
-	
-	
-	float amplitude = powf(10.0, amplitudeDB / 20);		// Convert dB to linear amplitude
-	
-	float frequencies[2];
-	frequencies[0] = frequency * (1.0 + detune);
-	frequencies[1] = frequency * (1.0 - detune);
-	
-    
+		// All the parameters share the same interval, so they are due together
+		if(gFrequency.needsUpdate()) {
+			float input0 = analogRead(context, n/2, 0);
+			float input1 = analogRead(context, n/2, 1);
+			float input2 = analogRead(context, n/2, 2);
+			
+			float amplitudeDB = map(input1, 0, 3.3 / 4.096, -40, -6);
+			
+			gFrequency.setTarget(55.0 * powf(2.0, input0 * 4.096));
+			gAmplitude.setTarget(powf(10.0, amplitudeDB / 20));		// Convert dB to linear amplitude
+			gDetune.setTarget(map(input2, 0, 3.3 / 4.096, 0, 0.05));
+		}
+		
+		float frequency = gFrequency.process();
+		float amplitude = gAmplitude.process();
+		float detune = gDetune.process();
+		
+		float frequencies[2];
+		frequencies[0] = frequency * (1.0 + detune);
+		frequencies[1] = frequency * (1.0 - detune);
     	
     	for(unsigned int i = 0; i < 2; i++) {
     		gOscillators[i].setFrequency(frequencies[i]);